@@ -0,0 +1,472 @@
+/*--------------------------------------------------------------------------
+    FILE                :   dspapi.c
+
+    PURPOSE             :   Source file for DSP API (dot product kernels,
+                            FFT and FFT-based cross-correlation)
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <pthread.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DSP_X86_KERNELS
+#include <immintrin.h>
+#endif
+#include "typedef.h"
+#include "dspapi.h"
+
+/*--------------------------------------------------------------------------
+    ===> PRIVATE <===
+ --------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+    General constants and data types
+ --------------------------------------------------------------------------*/
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct dsp_fft {
+    uint32_t      size;                         /* Number of points (power of 2) */
+    uint32_t      *bitrev;                      /* Bit-reversal permutation */
+    dsp_complex_t *twiddle;                     /* exp(-2*pi*i*k/size), k < size/2 */
+    dsp_complex_t *work;                        /* Scratch buffer (size points) */
+};
+
+typedef int64_t (*dsp_dot_t)(int16_t x[], int16_t y[], uint32_t points);
+
+/*--------------------------------------------------------------------------
+    Local variables
+ --------------------------------------------------------------------------*/
+
+/*
+ * Dot product kernel. The best one is selected once, the first time
+ * the kernel is needed, which may happen on several threads at once.
+ */
+static dsp_dot_t      dotProduct;
+static int            dotKernel = DSP_KERNEL_AUTO;
+static pthread_once_t dotKernelOnce = PTHREAD_ONCE_INIT;
+
+/*--------------------------------------------------------------------------
+    DSP_DotProductScalar
+
+    Description:
+        Portable int16 x int16 -> int64 multiply-accumulate.
+ --------------------------------------------------------------------------*/
+
+static int64_t DSP_DotProductScalar(int16_t x[], int16_t y[], uint32_t points)
+{
+    int64_t  sum = 0;
+    uint32_t j;
+
+    for (j = 0; j < points; j++) {
+        sum += x[j] * y[j];
+    }
+
+    return sum;
+}
+
+#ifdef DSP_X86_KERNELS
+/*--------------------------------------------------------------------------
+    DSP_DotProductSSE2
+
+    Description:
+        SSE2 int16 x int16 -> int64 multiply-accumulate. Each pmaddwd
+        lane holds the sum of two products, which only overflows for
+        (-32768 * -32768) * 2 = 2^31, wrapping to INT32_MIN. No other
+        pair sum can reach INT32_MIN, so that lane is zero-extended
+        instead of sign-extended when widened to 64 bits.
+ --------------------------------------------------------------------------*/
+
+__attribute__((target("sse2")))
+static int64_t DSP_DotProductSSE2(int16_t x[], int16_t y[], uint32_t points)
+{
+    __m128i  zero = _mm_setzero_si128();
+    __m128i  wrap = _mm_set1_epi32(INT32_MIN);
+    __m128i  acc = _mm_setzero_si128();
+    __m128i  p, sign;
+    int64_t  lanes[2], sum;
+    uint32_t j;
+
+    for (j = 0; (j + 8) <= points; j += 8) {
+        p = _mm_madd_epi16(_mm_loadu_si128((__m128i *) &x[j]), _mm_loadu_si128((__m128i *) &y[j]));
+        sign = _mm_andnot_si128(_mm_cmpeq_epi32(p, wrap), _mm_cmpgt_epi32(zero, p));
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(p, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(p, sign));
+    }
+
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    sum = lanes[0] + lanes[1];
+
+    for ( ; j < points; j++) {
+        sum += x[j] * y[j];
+    }
+
+    return sum;
+}
+
+/*--------------------------------------------------------------------------
+    DSP_DotProductAVX2
+
+    Description:
+        AVX2 version of DSP_DotProductSSE2.
+ --------------------------------------------------------------------------*/
+
+__attribute__((target("avx2")))
+static int64_t DSP_DotProductAVX2(int16_t x[], int16_t y[], uint32_t points)
+{
+    __m256i  zero = _mm256_setzero_si256();
+    __m256i  wrap = _mm256_set1_epi32(INT32_MIN);
+    __m256i  acc0 = _mm256_setzero_si256();
+    __m256i  acc1 = _mm256_setzero_si256();
+    __m256i  p, sign;
+    int64_t  lanes[4], sum;
+    uint32_t j;
+
+    for (j = 0; (j + 16) <= points; j += 16) {
+        p = _mm256_madd_epi16(_mm256_loadu_si256((__m256i *) &x[j]), _mm256_loadu_si256((__m256i *) &y[j]));
+        sign = _mm256_andnot_si256(_mm256_cmpeq_epi32(p, wrap), _mm256_cmpgt_epi32(zero, p));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(p, sign));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(p, sign));
+    }
+
+    _mm256_storeu_si256((__m256i *) lanes, _mm256_add_epi64(acc0, acc1));
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    for ( ; j < points; j++) {
+        sum += x[j] * y[j];
+    }
+
+    return sum;
+}
+#endif /* DSP_X86_KERNELS */
+
+/*--------------------------------------------------------------------------
+    DSP_SetKernel
+
+    Description:
+        Sets the dot product kernel (see DSP_SelectKernel).
+ --------------------------------------------------------------------------*/
+
+static int DSP_SetKernel(int kernel)
+{
+#ifdef DSP_X86_KERNELS
+    __builtin_cpu_init();
+
+    if (DSP_KERNEL_AUTO == kernel) {
+        kernel = __builtin_cpu_supports("avx2") ? DSP_KERNEL_AVX2 :
+                 __builtin_cpu_supports("sse2") ? DSP_KERNEL_SSE2 : DSP_KERNEL_SCALAR;
+    }
+
+    if ((DSP_KERNEL_AVX2 == kernel) && __builtin_cpu_supports("avx2")) {
+        dotProduct = DSP_DotProductAVX2;
+    } else if ((DSP_KERNEL_SSE2 == kernel) && __builtin_cpu_supports("sse2")) {
+        dotProduct = DSP_DotProductSSE2;
+    } else if (DSP_KERNEL_SCALAR == kernel) {
+        dotProduct = DSP_DotProductScalar;
+    } else {
+        return EINVAL;
+    }
+#else
+    if ((DSP_KERNEL_AUTO != kernel) && (DSP_KERNEL_SCALAR != kernel)) {
+        return EINVAL;
+    }
+
+    kernel = DSP_KERNEL_SCALAR;
+    dotProduct = DSP_DotProductScalar;
+#endif
+
+    dotKernel = kernel;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    DSP_AutoKernel
+
+    Description:
+        Selects the best dot product kernel supported by the CPU.
+ --------------------------------------------------------------------------*/
+
+static void DSP_AutoKernel(void)
+{
+    DSP_SetKernel(DSP_KERNEL_AUTO);
+}
+
+/*--------------------------------------------------------------------------
+    ===> PUBLIC <===
+ --------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+    DSP_SelectKernel
+
+    Description:
+        Call this function to select the dot product kernel. With
+        DSP_KERNEL_AUTO, the kernel is chosen from the CPUID feature
+        flags. All the kernels return the same exact result. The
+        kernel must not be changed while other threads use this API.
+
+    Return Value:
+        0 if the kernel was selected; otherwise EINVAL if the kernel
+        is unknown or not supported by the CPU.
+ --------------------------------------------------------------------------*/
+
+int DSP_SelectKernel(int kernel)
+{
+    pthread_once(&dotKernelOnce, DSP_AutoKernel);
+
+    return DSP_SetKernel(kernel);
+}
+
+/*--------------------------------------------------------------------------
+    DSP_GetKernel
+
+    Description:
+        Returns the dot product kernel in use.
+ --------------------------------------------------------------------------*/
+
+int DSP_GetKernel(void)
+{
+    pthread_once(&dotKernelOnce, DSP_AutoKernel);
+
+    return dotKernel;
+}
+
+/*--------------------------------------------------------------------------
+    DSP_DotProduct
+
+    Description:
+        Computes the exact dot product of two int16 signals.
+
+    Parameters:
+        x and y - Input signals
+        points - Number of points used to compute
+ --------------------------------------------------------------------------*/
+
+int64_t DSP_DotProduct(int16_t x[], int16_t y[], uint32_t points)
+{
+    pthread_once(&dotKernelOnce, DSP_AutoKernel);
+
+    return dotProduct(x, y, points);
+}
+
+/*--------------------------------------------------------------------------
+    DSP_FFTCreate
+
+    Description:
+        Creates an FFT plan for a given number of points. The size
+        must be a power of 2 greater than 1.
+
+    Return Value:
+        0 if the plan was created; otherwise EINVAL or ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int DSP_FFTCreate(uint32_t size, dsp_fft_t **fft)
+{
+    dsp_fft_t *p;
+    uint32_t  i, j, bits;
+
+    if ((size < 2) || (0 != (size & (size - 1)))) {
+        return EINVAL;
+    }
+
+    if (NULL == (p = (dsp_fft_t *) calloc(1, sizeof(dsp_fft_t)))) {
+        return ENOMEM;
+    }
+
+    p->size    = size;
+    p->bitrev  = (uint32_t *) malloc(size * sizeof(uint32_t));
+    p->twiddle = (dsp_complex_t *) malloc((size / 2) * sizeof(dsp_complex_t));
+    p->work    = (dsp_complex_t *) malloc(size * sizeof(dsp_complex_t));
+    if ((NULL == p->bitrev) || (NULL == p->twiddle) || (NULL == p->work)) {
+        DSP_FFTDestroy(p);
+        return ENOMEM;
+    }
+
+    for (bits = 0; (1U << bits) < size; bits++)
+        ;
+
+    for (i = 0; i < size; i++) {
+        for (j = 0, p->bitrev[i] = 0; j < bits; j++) {
+            p->bitrev[i] |= ((i >> j) & 1) << (bits - 1 - j);
+        }
+    }
+
+    for (i = 0; i < size / 2; i++) {
+        p->twiddle[i].re = cos(2.0 * M_PI * i / size);
+        p->twiddle[i].im = -sin(2.0 * M_PI * i / size);
+    }
+
+    *fft = p;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    DSP_FFTDestroy
+
+    Description:
+        Frees an FFT plan created by DSP_FFTCreate.
+ --------------------------------------------------------------------------*/
+
+void DSP_FFTDestroy(dsp_fft_t *fft)
+{
+    if (NULL == fft) {
+        return;
+    }
+
+    free(fft->bitrev);
+    free(fft->twiddle);
+    free(fft->work);
+    free(fft);
+}
+
+/*--------------------------------------------------------------------------
+    DSP_FFTGetSize
+
+    Description:
+        Returns the number of points of an FFT plan.
+ --------------------------------------------------------------------------*/
+
+uint32_t DSP_FFTGetSize(dsp_fft_t *fft)
+{
+    return fft->size;
+}
+
+/*--------------------------------------------------------------------------
+    DSP_FFT
+
+    Description:
+        In-place iterative radix-2 FFT. The inverse transform is
+        scaled by 1/size.
+
+    Parameters:
+        fft - FFT plan
+        data - Signal to transform (size points)
+        inverse - Nonzero for the inverse transform
+ --------------------------------------------------------------------------*/
+
+void DSP_FFT(dsp_fft_t *fft, dsp_complex_t data[], int inverse)
+{
+    dsp_complex_t u, t, w;
+    uint32_t      size = fft->size;
+    uint32_t      i, j, len, half, step;
+    double        scale;
+
+    /*
+     * Reorder the input in bit-reversed order.
+     */
+    for (i = 0; i < size; i++) {
+        if (i < (j = fft->bitrev[i])) {
+            u = data[i];
+            data[i] = data[j];
+            data[j] = u;
+        }
+    }
+
+    /*
+     * Butterflies.
+     */
+    for (len = 2; len <= size; len <<= 1) {
+        half = len / 2;
+        step = size / len;
+        for (i = 0; i < size; i += len) {
+            for (j = 0; j < half; j++) {
+                w = fft->twiddle[j * step];
+                if (inverse) w.im = -w.im;
+                u = data[i + j];
+                t.re = data[i + j + half].re * w.re - data[i + j + half].im * w.im;
+                t.im = data[i + j + half].re * w.im + data[i + j + half].im * w.re;
+                data[i + j].re = u.re + t.re;
+                data[i + j].im = u.im + t.im;
+                data[i + j + half].re = u.re - t.re;
+                data[i + j + half].im = u.im - t.im;
+            }
+        }
+    }
+
+    if (inverse) {
+        scale = 1.0 / size;
+        for (i = 0; i < size; i++) {
+            data[i].re *= scale;
+            data[i].im *= scale;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------
+    DSP_CrossCorrelate
+
+    Description:
+        Computes c(d) = sum x(j) * y(j+d), for 0 <= d < lags, using a
+        single complex FFT of the packed signal x + iy followed by an
+        inverse FFT. Samples outside x[0..xSize) and y[0..ySize) are
+        treated as zeros.
+
+    Parameters:
+        fft - FFT plan (size >= xSize + lags - 1 and size >= ySize)
+        x and y - Input signals
+        xSize and ySize - Number of points of x and y
+        c - Cross-correlation (lags points)
+        lags - Number of lags to compute
+
+    Return Value:
+        0 on success; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int DSP_CrossCorrelate(dsp_fft_t *fft, int16_t x[], uint32_t xSize, int16_t y[], uint32_t ySize, double c[], uint32_t lags)
+{
+    dsp_complex_t *z = fft->work;
+    dsp_complex_t a, b, X, Y;
+    uint32_t      size = fft->size;
+    uint32_t      k;
+
+    if ((0 == lags) || ((xSize + lags - 1) > size) || (ySize > size)) {
+        return EINVAL;
+    }
+
+    /*
+     * Pack both real signals into one complex signal.
+     */
+    for (k = 0; k < size; k++) {
+        z[k].re = (k < xSize) ? x[k] : 0.0;
+        z[k].im = (k < ySize) ? y[k] : 0.0;
+    }
+
+    DSP_FFT(fft, z, 0);
+
+    /*
+     * Separate the two spectra, X(k) = (Z(k) + Z*(-k)) / 2 and
+     * Y(k) = (Z(k) - Z*(-k)) / 2i, and form C(k) = X*(k) Y(k).
+     * Since C(-k) = C*(k), each pair (k, -k) is handled at once.
+     */
+    for (k = 0; k <= size / 2; k++) {
+        a = z[k];
+        b = z[(size - k) & (size - 1)];
+
+        X.re = 0.5 * (a.re + b.re);
+        X.im = 0.5 * (a.im - b.im);
+        Y.re = 0.5 * (a.im + b.im);
+        Y.im = 0.5 * (b.re - a.re);
+
+        z[k].re = X.re * Y.re + X.im * Y.im;
+        z[k].im = X.re * Y.im - X.im * Y.re;
+        z[(size - k) & (size - 1)].re = z[k].re;
+        z[(size - k) & (size - 1)].im = -z[k].im;
+    }
+
+    DSP_FFT(fft, z, 1);
+
+    for (k = 0; k < lags; k++) {
+        c[k] = z[k].re;
+    }
+
+    return 0;
+}
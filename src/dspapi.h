@@ -0,0 +1,56 @@
+/*--------------------------------------------------------------------------
+    FILE                :   dspapi.h
+
+    PURPOSE             :   Interface for DSP API
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#ifndef __DSPAPI_H                              /* Prevent multiple includes */
+#define __DSPAPI_H
+
+#include "typedef.h"
+
+#ifdef __cplusplus
+extern "C" {                                    /* Assume C declarations for C++ */
+#endif /* __cplusplus */
+
+/*--------------------------------------------------------------------------
+    General constants and data types
+ --------------------------------------------------------------------------*/
+
+struct dsp_complex {
+    double re;                                  /* Real part */
+    double im;                                  /* Imaginary part */
+};
+
+typedef struct dsp_complex dsp_complex_t;
+
+typedef struct dsp_fft dsp_fft_t;               /* Opaque FFT plan */
+
+#define DSP_KERNEL_AUTO     0                   /* Best kernel supported by the CPU */
+#define DSP_KERNEL_SCALAR   1                   /* Portable C */
+#define DSP_KERNEL_SSE2     2                   /* x86 SSE2 (pmaddwd) */
+#define DSP_KERNEL_AVX2     3                   /* x86 AVX2 (vpmaddwd) */
+
+/*--------------------------------------------------------------------------
+    Prototypes
+ --------------------------------------------------------------------------*/
+
+int DSP_SelectKernel(int kernel);
+int DSP_GetKernel(void);
+int64_t DSP_DotProduct(int16_t x[], int16_t y[], uint32_t points);
+int DSP_FFTCreate(uint32_t size, dsp_fft_t **fft);
+void DSP_FFTDestroy(dsp_fft_t *fft);
+uint32_t DSP_FFTGetSize(dsp_fft_t *fft);
+void DSP_FFT(dsp_fft_t *fft, dsp_complex_t data[], int inverse);
+int DSP_CrossCorrelate(dsp_fft_t *fft, int16_t x[], uint32_t xSize, int16_t y[], uint32_t ySize, double c[], uint32_t lags);
+
+#ifdef __cplusplus
+}                                               /* End of extern "C" { */
+#endif /* __cplusplus */
+
+#endif /* __DSPAPI_H */
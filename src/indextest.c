@@ -0,0 +1,226 @@
+/*--------------------------------------------------------------------------
+    FILE                :   indextest.c
+
+    PURPOSE             :   Regression test of the 64-bit frame and sample
+                            indexes of the SOLA engine: more than 100k
+                            frames in one call, and an output position
+                            past 2^32 through the streaming API
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "typedef.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define SMALL_FRAMESIZE 25U                     /* Sa = 9 at alpha = 1.3, so > 100k frames */
+#define SMALL_SIZE      2000000U                /* Samples of the first test */
+
+#define LARGE_FRAMESIZE 1000U
+#define LARGE_ALPHA     0.9F                    /* Sa = 500, Ss = 450 */
+#define CHUNK           65536U                  /* Samples per SOLA_CtxPush */
+#define BURST           (4U * LARGE_FRAMESIZE)  /* Samples of each tone burst */
+#define FIRST_FRAME     2000U                   /* Frame of the first burst */
+#define MARGIN          (2U * LARGE_FRAMESIZE)  /* Output compared around a burst */
+#define WINDOW          (BURST + 2U * MARGIN)
+
+/*--------------------------------------------------------------------------
+    Fail
+
+    Description:
+        Displays a failure and exits.
+ --------------------------------------------------------------------------*/
+
+void Fail(const char *what)
+{
+    fprintf(stderr, "indextest: FAILED: %s\n", what);
+    exit(1);
+}
+
+/*--------------------------------------------------------------------------
+    Tone
+
+    Description:
+        Returns sample i of a voiced-like tone burst.
+ --------------------------------------------------------------------------*/
+
+int16_t Tone(uint32_t i)
+{
+    return (int16_t) (8000.0 * sin(i * 0.0731) + 4000.0 * sin(i * 0.2113 + 1.0));
+}
+
+/*--------------------------------------------------------------------------
+    TestManyFrames
+
+    Description:
+        Time-scales a signal of more than 100k frames with
+        SOLA_CtxProcess, and checks that the streaming API gives the
+        same output.
+ --------------------------------------------------------------------------*/
+
+void TestManyFrames(void)
+{
+    sola_ctx_t   *ctx;
+    sola_stats_t stats;
+    int16_t      *x, *y, *z;
+    uint64_t     ySize, zSize = 0;
+    uint32_t     i, n, count;
+
+    if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetFrameSize(ctx, SMALL_FRAMESIZE))) {
+        Fail("context");
+    }
+    memset(&stats, 0, sizeof(stats));
+    SOLA_CtxSetStats(ctx, &stats);
+    if (NULL == (x = (int16_t *) malloc(SMALL_SIZE * sizeof(int16_t)))) {
+        Fail("memory");
+    }
+    for (i = 0; i < SMALL_SIZE; i++) {
+        x[i] = (int16_t) (Tone(i) * (0.5 + 0.5 * sin(i * 0.0003)));
+    }
+
+    if (0 != SOLA_CtxProcess(ctx, x, SMALL_SIZE, &y, &ySize, 1.3f)) {
+        Fail("SOLA_CtxProcess");
+    }
+    if (stats.frames <= 100000) {
+        Fail("not enough frames");
+    }
+    SOLA_CtxSetStats(ctx, NULL);
+
+    if ((0 != SOLA_CtxBegin(ctx, 1.3f)) ||
+        (NULL == (z = (int16_t *) malloc((size_t) SOLA_CtxGetStreamBound(ctx, SMALL_SIZE) * sizeof(int16_t))))) {
+        Fail("SOLA_CtxBegin");
+    }
+    for (i = 0; i < SMALL_SIZE; i += count) {
+        count = ((SMALL_SIZE - i) < CHUNK) ? (SMALL_SIZE - i) : CHUNK;
+        if (0 != SOLA_CtxPush(ctx, &x[i], count, &z[zSize], &n)) {
+            Fail("SOLA_CtxPush");
+        }
+        zSize += n;
+    }
+    if (0 != SOLA_CtxFlush(ctx, &z[zSize], &n)) {
+        Fail("SOLA_CtxFlush");
+    }
+    zSize += n;
+
+    if ((zSize != ySize) || (0 != memcmp(y, z, (size_t) ySize * sizeof(int16_t)))) {
+        Fail("streamed output differs from SOLA_CtxProcess");
+    }
+
+    free(x);
+    free(y);
+    free(z);
+    SOLA_CtxDestroy(ctx);
+}
+
+/*--------------------------------------------------------------------------
+    TestLargePosition
+
+    Description:
+        Streams silence with two identical tone bursts, one near the
+        start and one just past output sample 2^32, each at the start
+        of a frame. Frames only depend on the samples around them, so
+        the output around both bursts must be the same. With alpha < 1,
+        Ss < N/2 and every frame overlaps more than N/2 points of the
+        previous one, which an index cut to 32 bits gets wrong.
+ --------------------------------------------------------------------------*/
+
+void TestLargePosition(void)
+{
+    sola_ctx_t *ctx;
+    int16_t    *x, *y, windows[2][WINDOW];
+    uint64_t   frames[2], bursts[2], outputs[2], xPos = 0, yPos = 0, start, end, p;
+    uint32_t   i, n, b, count;
+    uint16_t   sa = LARGE_FRAMESIZE / 2;        /* See SOLA_GetIntervals */
+    uint16_t   ss = (uint16_t) (sa * LARGE_ALPHA);
+
+    frames[0] = FIRST_FRAME;
+    frames[1] = (((1ULL << 32) + MARGIN) / ss) + 1;
+    for (b = 0; b < 2; b++) {
+        bursts[b] = frames[b] * sa;
+        outputs[b] = frames[b] * ss;
+    }
+    end = bursts[1] + BURST + 4 * LARGE_FRAMESIZE;
+
+    if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetFrameSize(ctx, LARGE_FRAMESIZE)) ||
+        (0 != SOLA_CtxSetSilenceThreshold(ctx, 1)) || (0 != SOLA_CtxBegin(ctx, LARGE_ALPHA))) {
+        Fail("context");
+    }
+    x = (int16_t *) malloc(CHUNK * sizeof(int16_t));
+    y = (int16_t *) malloc((size_t) SOLA_CtxGetStreamBound(ctx, CHUNK) * sizeof(int16_t));
+    if ((NULL == x) || (NULL == y)) {
+        Fail("memory");
+    }
+    memset(windows[0], 0x55, sizeof(windows[0]));
+    memset(windows[1], 0xAA, sizeof(windows[1]));
+
+    memset(x, 0, CHUNK * sizeof(int16_t));
+
+    /*
+     * Only the chunks near a burst are filled and looked at, the rest
+     * of the input is the same silent chunk.
+     */
+    while (xPos < end) {
+        count = ((end - xPos) < CHUNK) ? (uint32_t) (end - xPos) : CHUNK;
+        for (b = 0; b < 2; b++) {
+            if (((xPos + count) > bursts[b]) && (xPos < (bursts[b] + BURST + CHUNK))) {
+                for (i = 0; i < count; i++) {
+                    p = xPos + i;
+                    x[i] = ((p >= bursts[b]) && (p < (bursts[b] + BURST))) ? Tone((uint32_t) (p - bursts[b])) : 0;
+                }
+            }
+        }
+        if (0 != SOLA_CtxPush(ctx, x, count, y, &n)) {
+            Fail("SOLA_CtxPush");
+        }
+        for (b = 0; b < 2; b++) {
+            start = outputs[b] - MARGIN;
+            if (((yPos + n) > start) && (yPos < (start + WINDOW))) {
+                for (i = 0; i < n; i++) {
+                    p = yPos + i;
+                    if ((p >= start) && (p < (start + WINDOW))) {
+                        windows[b][p - start] = y[i];
+                    }
+                }
+            }
+        }
+        yPos += n;
+        xPos += count;
+    }
+
+    if (yPos < outputs[1] - MARGIN + WINDOW) {
+        Fail("output too short");
+    }
+    if (0 != memcmp(windows[0], windows[1], sizeof(windows[0]))) {
+        Fail("output past sample 2^32 differs");
+    }
+
+    free(x);
+    free(y);
+    SOLA_CtxDestroy(ctx);
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(void)
+{
+    TestManyFrames();
+    printf("indextest: more than 100k frames: OK\n");
+
+    TestLargePosition();
+    printf("indextest: output position past 2^32: OK\n");
+
+    return 0;
+}
@@ -0,0 +1,341 @@
+/*--------------------------------------------------------------------------
+    FILE                :   kerneltest.c
+
+    PURPOSE             :   Test of the dot product kernels (scalar, SSE2
+                            and AVX2) and of the lag searches (direct and
+                            FFT): every combination must give the same
+                            dot products, and the same lags as the
+                            original per-lag search (see RefTSM)
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "typedef.h"
+#include "dspapi.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define KERNELS  3                              /* Scalar, SSE2 & AVX2 */
+#define SIGNALS  3
+#define SIGNAL   16000U                         /* 2 seconds at 8 kHz */
+#define VECTOR   1100U                          /* Points of the dot product checks */
+
+/*--------------------------------------------------------------------------
+    Local variables
+ --------------------------------------------------------------------------*/
+
+static const int  kernels[KERNELS] = { DSP_KERNEL_SCALAR, DSP_KERNEL_SSE2, DSP_KERNEL_AVX2 };
+static const char *kernelNames[KERNELS] = { "scalar", "sse2", "avx2" };
+static const char *signalNames[SIGNALS] = { "tone", "noise", "clipped" };
+static uint32_t   seed = 1;
+
+/*--------------------------------------------------------------------------
+    Random
+
+    Description:
+        Returns a deterministic pseudo-random 16-bit sample (LCG).
+ --------------------------------------------------------------------------*/
+
+int16_t Random(void)
+{
+    seed = seed * 1664525U + 1013904223U;
+
+    return (int16_t) (seed >> 16);
+}
+
+/*--------------------------------------------------------------------------
+    Generate
+
+    Description:
+        Generates a test signal. The clipped signal is an overdriven
+        tone, with runs of -32768 on both x and y of the lag search, so
+        that the pmaddwd pairs (-32768 * -32768) * 2 are widened.
+ --------------------------------------------------------------------------*/
+
+void Generate(int signal, int16_t x[], uint32_t size)
+{
+    double   v;
+    uint32_t i;
+
+    for (i = 0; i < size; i++) {
+        v = 8000.0 * sin(i * 0.0731) + 4000.0 * sin(i * 0.2113 + 1.0);
+        switch (signal) {
+        case 0:
+            x[i] = (int16_t) v;
+            break;
+        case 1:
+            x[i] = Random();
+            break;
+        default:
+            v *= 8.0;
+            x[i] = (v <= -32768.0) ? -32768 : (v >= 32767.0) ? 32767 : (int16_t) v;
+            break;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------
+    Fail
+
+    Description:
+        Displays a failure and exits.
+ --------------------------------------------------------------------------*/
+
+void Fail(const char *what)
+{
+    fprintf(stderr, "kerneltest: FAILED: %s\n", what);
+    exit(1);
+}
+
+/*--------------------------------------------------------------------------
+    TestDotProduct
+
+    Description:
+        Checks a kernel against a plain int64 dot product, on every
+        length up to VECTOR points (so every tail), at every alignment,
+        on vectors of -32768 pairs, of extreme values and of noise.
+ --------------------------------------------------------------------------*/
+
+void TestDotProduct(void)
+{
+    int16_t  x[VECTOR + 16], y[VECTOR + 16];
+    int64_t  ref;
+    uint32_t i, n, offset;
+    int      k, v;
+
+    for (v = 0; v < 3; v++) {
+        for (i = 0; i < VECTOR + 16; i++) {
+            switch (v) {
+            case 0:
+                x[i] = y[i] = -32768;
+                break;
+            case 1:
+                x[i] = (i & 1) ? 32767 : -32768;
+                y[i] = (i & 2) ? 32767 : -32768;
+                break;
+            default:
+                x[i] = Random();
+                y[i] = (i % 3) ? Random() : -32768;
+                break;
+            }
+        }
+
+        for (offset = 0; offset < 16; offset++) {
+            for (n = 0; (n + offset) <= VECTOR; n += (n < 64) ? 1 : 37) {
+                for (ref = 0, i = 0; i < n; i++) {
+                    ref += (int64_t) x[offset + i] * y[offset + i];
+                }
+                for (k = 0; k < KERNELS; k++) {
+                    if (0 != DSP_SelectKernel(kernels[k])) {
+                        continue;
+                    }
+                    if (DSP_DotProduct(&x[offset], &y[offset], n) != ref) {
+                        fprintf(stderr, "kerneltest: %s, vector %d, offset %u, %u points\n", kernelNames[k], v, offset, n);
+                        Fail("DSP_DotProduct");
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------
+    RefCrossCorrelation
+
+    Description:
+        Copy of the original SOLA_CrossCorrelation: the normalized
+        cross-correlation of one lag, summed in double.
+ --------------------------------------------------------------------------*/
+
+float RefCrossCorrelation(int16_t x[], int16_t y[], uint16_t points)
+{
+    double   sum[3] = {0.0, 0.0, 0.0};
+    double   denom;
+    uint16_t j;
+
+    for (j = 0; j < points; j++) {
+        sum[0] += x[j] * y[j];                  /* Numerator */
+        sum[1] += x[j] * x[j];                  /* Denominator */
+        sum[2] += y[j] * y[j];
+    }
+
+    if (0.0 == (denom = sqrt(sum[1] * sum[2]))) {
+        return 0.0;
+    }
+
+    return (float) (sum[0] / denom);
+}
+
+/*--------------------------------------------------------------------------
+    RefTSM
+
+    Description:
+        Copy of the original SOLA_TSM, SOLA_FindLag and
+        SOLA_OverlapFrame, with 64-bit indexes: every lag is
+        correlated on its own with RefCrossCorrelation. Records the
+        lag of every frame, and returns the output in memory freed by
+        the caller.
+ --------------------------------------------------------------------------*/
+
+void RefTSM(int16_t x[], uint16_t N, float alpha, int16_t lags[], uint64_t *count, int16_t *y[], uint64_t *ySize)
+{
+    uint16_t sa, ss, L, Lm, j;
+    uint64_t m, maxFrames, lastSampleIndex;
+    int16_t  k, km;
+    float    R, Rm;
+
+    sa = (uint16_t) ((alpha > 1.0) ? (N / (2 * alpha)) : (N / 2));
+    ss = (uint16_t) (sa * alpha);
+
+    if (NULL == (*y = (int16_t *) calloc((size_t) (SIGNAL * alpha) + 2 * N, sizeof(int16_t)))) {
+        Fail("memory");
+    }
+    memcpy(*y, x, N * sizeof(int16_t));
+
+    lastSampleIndex = N;
+    maxFrames = (SIGNAL - N) / sa;
+
+    for (m = 1; m <= maxFrames; m++) {
+        km = 0;
+        Rm = -1;
+        k = -(((m * ss) >= (N / 2U)) ? (N / 2) : ss);
+
+        L = N;
+        if ((((m * ss) + k) + N) > lastSampleIndex) {
+            L = (uint16_t) (lastSampleIndex - ((m * ss) + k));
+        }
+
+        for ( ; k <= (N / 2); k++, L--) {
+            if (L < (N / 8))
+                break;
+
+            if ((R = RefCrossCorrelation(&x[m * sa], &(*y)[m * ss + k], L)) > Rm) {
+                Rm = R;
+                km = k;
+            }
+        }
+
+        Lm = N;
+        if ((((m * ss) + km) + N) > lastSampleIndex) {
+            Lm = (uint16_t) (lastSampleIndex - ((m * ss) + km));
+        }
+        for (j = 0; j < Lm; j++) {
+            (*y)[m * ss + km + j] = (int16_t) ((1 - j / Lm) * (*y)[m * ss + km + j] + (j / Lm) * x[m * sa + j]);
+        }
+        if (Lm < N) {
+            memcpy(&(*y)[m * ss + km + Lm], &x[m * sa + Lm], (N - Lm) * sizeof(int16_t));
+        }
+
+        lags[m - 1] = km;
+        lastSampleIndex = (m * ss) + km + N;
+    }
+
+    *count = maxFrames;
+    *ySize = lastSampleIndex;
+}
+
+/*--------------------------------------------------------------------------
+    RecordLags
+
+    Description:
+        Time-scales a signal and records the lag of every frame.
+ --------------------------------------------------------------------------*/
+
+void RecordLags(int16_t x[], uint16_t frameSize, float alpha, int method, int16_t lags[], uint64_t *count,
+                int16_t *y[], uint64_t *ySize)
+{
+    sola_ctx_t *ctx;
+
+    if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetFrameSize(ctx, frameSize)) ||
+        (0 != SOLA_CtxSetSearchMethod(ctx, method))) {
+        Fail("context");
+    }
+    *count = SOLA_CtxGetLagCount(ctx, SIGNAL, alpha);
+    if ((*count > SIGNAL) || (0 != SOLA_CtxSetLagTrack(ctx, SOLA_LAGS_RECORD, lags, *count)) ||
+        (0 != SOLA_CtxProcess(ctx, x, SIGNAL, y, ySize, alpha))) {
+        Fail("SOLA_CtxProcess");
+    }
+    SOLA_CtxDestroy(ctx);
+}
+
+/*--------------------------------------------------------------------------
+    TestLags
+
+    Description:
+        Checks that every kernel, with the direct and the FFT search,
+        finds the same lag for every frame (and so the same output) as
+        the original per-lag search.
+ --------------------------------------------------------------------------*/
+
+void TestLags(void)
+{
+    static const uint16_t frameSizes[] = { 160, 400 };
+    static const float    alphas[] = { 0.5f, 0.8f, 1.5f, 2.0f };
+    static const int      methods[] = { SOLA_SEARCH_DIRECT, SOLA_SEARCH_FFT };
+    static int16_t        x[SIGNAL], refLags[SIGNAL], lags[SIGNAL];
+    int16_t               *ref, *y;
+    uint64_t              refCount, count, refSize, ySize;
+    size_t                n, a, m;
+    int                   s, k;
+
+    for (s = 0; s < SIGNALS; s++) {
+        Generate(s, x, SIGNAL);
+
+        for (n = 0; n < sizeof(frameSizes) / sizeof(frameSizes[0]); n++) {
+            for (a = 0; a < sizeof(alphas) / sizeof(alphas[0]); a++) {
+                RefTSM(x, frameSizes[n], alphas[a], refLags, &refCount, &ref, &refSize);
+
+                for (k = 0; k < KERNELS; k++) {
+                    if (0 != DSP_SelectKernel(kernels[k])) {
+                        continue;
+                    }
+                    for (m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+                        RecordLags(x, frameSizes[n], alphas[a], methods[m], lags, &count, &y, &ySize);
+                        if ((count != refCount) || (0 != memcmp(lags, refLags, (size_t) count * sizeof(int16_t))) ||
+                            (ySize != refSize) || (0 != memcmp(y, ref, (size_t) ySize * sizeof(int16_t)))) {
+                            fprintf(stderr, "kerneltest: %s, %s search, %s, framesize %u, alpha %g\n", kernelNames[k],
+                                    (SOLA_SEARCH_FFT == methods[m]) ? "FFT" : "direct", signalNames[s],
+                                    frameSizes[n], alphas[a]);
+                            Fail("lags differ from the original search");
+                        }
+                        free(y);
+                    }
+                }
+                free(ref);
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(void)
+{
+    int k;
+
+    for (k = 0; k < KERNELS; k++) {
+        printf("kerneltest: %s kernel %s\n", kernelNames[k],
+               (0 == DSP_SelectKernel(kernels[k])) ? "tested" : "not supported, skipped");
+    }
+
+    TestDotProduct();
+    printf("kerneltest: dot products: OK\n");
+
+    TestLags();
+    printf("kerneltest: lags of the direct and FFT searches, as the original search: OK\n");
+
+    return 0;
+}
@@ -11,10 +11,21 @@
     Revision 1.0a   ==>     (SR) compiled using gcc 4.8.4
  --------------------------------------------------------------------------*/
 
+#include <errno.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <getopt.h>
+#include <glob.h>
+#include <libgen.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
 #include "typedef.h"
 #include "ulawapi.h"
 #include "solaapi.h"
@@ -33,7 +44,7 @@
 #define VER_REVISION    'a'
 #define VER_COPYRIGHT   "Copyright (c) Stephane Rheaume 2016, All Rights Reserved"
 
-#define PRINT_VERSION_INFO() (printf("%s - v%d.%d%c. Built on %s at %s\n%s\n\n", \
+#define PRINT_VERSION_INFO(stream) (fprintf(stream, "%s - v%d.%d%c. Built on %s at %s\n%s\n\n", \
                                      VER_NAME, VER_MAJOR, VER_MINOR, \
                                      VER_REVISION, __DATE__, __TIME__, \
                                      VER_COPYRIGHT))
@@ -46,6 +57,105 @@
 #define MAX_ALPHA     2.0F
 #define MIN_FRAMESIZE 25U
 #define MAX_FRAMESIZE 1000U
+#define WINDOW_SIZE   4096U                     /* Samples decoded at a time */
+#define LARGE_OUTPUT  (16U << 20)               /* Samples above which write hints are given */
+#define MAX_CHANNELS  64U
+#define MAX_JOBS      256U                      /* Worker threads of the batch mode */
+
+#define LAGS_INDEPENDENT 0                      /* Each channel finds its own lags */
+#define LAGS_PRIMARY     1                      /* Lags of the first channel */
+#define LAGS_SUM         2                      /* Lags of the sum of the channels */
+
+#define MAX_BREAKPOINTS  256U                   /* Breakpoints of --schedule */
+
+#define AUTO_FRAMESIZE   0xFFFFU                /* <framesize> = auto */
+#define AUTO_WINDOWS     32U                    /* Windows analyzed per file */
+#define AUTO_WINDOW_SIZE (3U * MAX_FRAMESIZE / 2U)
+#define AUTO_THRESHOLD   0.7F                   /* Lowest correlation of a period */
+#define AUTO_PERCENTILE  90U                    /* Period the frames are sized for */
+
+/*--------------------------------------------------------------------------
+    General constants and data types
+ --------------------------------------------------------------------------*/
+
+struct breakpoint {
+    double time;                                /* Seconds from the start */
+    float  alpha;                               /* Time-scale factor at that time */
+};
+
+typedef struct breakpoint breakpoint_t;
+
+struct buffer_pool {
+    int16_t *buffers[MAX_CHANNELS];             /* Output buffer of each channel */
+    size_t  sizes[MAX_CHANNELS];                /* Samples of each buffer */
+};
+
+typedef struct buffer_pool buffer_pool_t;
+
+struct channel_job {
+    sola_ctx_t *ctx;                            /* SOLA context of the channel */
+    ulaw_map_t *map;                            /* Memory-mapped source file */
+    uint16_t   channel;                         /* Channel (1 = first, 0 = sum) */
+    float      alpha;                           /* Time-scale factor */
+    float      maxAlpha;                        /* Largest alpha of the schedule */
+    uint64_t   segmentSize;                     /* Segment size (0 = not segmented) */
+    uint32_t   threads;                         /* Threads of the segments */
+    uint32_t   blockSize;                       /* Realtime block (0 = not realtime) */
+    buffer_pool_t *pool;                        /* Output buffers (NULL = allocated) */
+    int16_t    *y;                              /* Synthetic signal */
+    uint32_t   ySize;
+    int        err;                             /* Result of TimeScale */
+    sola_stats_t stats;                         /* Statistics of the channel */
+    pthread_t  thread;
+};
+
+typedef struct channel_job channel_job_t;
+
+struct file_job {
+    char     *source;                           /* File to be time-scale modified */
+    char     *destination;                      /* Destination file */
+    float    alpha;                             /* Time-scale factor */
+    uint16_t frameSize;                         /* Size of the frames (0 = default, AUTO_FRAMESIZE) */
+    uint16_t usedFrameSize;                     /* Size of the frames actually used */
+    uint64_t segmentSize;                       /* Segment size (0 = not segmented) */
+    uint32_t threads;                           /* Threads of the segments */
+    uint32_t blockSize;                         /* Realtime block (0 = not realtime) */
+    uint16_t decimation;                        /* Coarse-to-fine search (0 = exhaustive) */
+    uint16_t candidates;
+    uint16_t window;                            /* Pitch-aware search (0 = exhaustive) */
+    float    threshold;
+    uint16_t silence;                           /* Silence gate (0 = off) */
+    const breakpoint_t *schedule;               /* Alpha schedule (NULL = constant) */
+    uint32_t points;                            /* Breakpoints of the schedule */
+    uint32_t format;                            /* ULAW_FORMAT_xxx (0 = that of the source) */
+    uint32_t channels;                          /* Number of channels */
+    buffer_pool_t *pool;                        /* Output buffers of the worker (NULL = none) */
+    uint64_t bytesRead, bytesWritten;
+    int      err;                               /* Result of ProcessFile */
+    char     message[256];                      /* Reason of the failure */
+
+    uint64_t     frames;                        /* Frames of all the channels */
+    uint64_t     silentFrames;                  /* Of which silent (see --silence) */
+
+    int          stats;                         /* Nonzero to collect statistics */
+    uint64_t     wallTime;                      /* Elapsed time of the file (ns) */
+    sola_stats_t tsmStats;                      /* TSM of all the channels */
+    ulaw_stats_t ioStats;                       /* Reading and writing */
+};
+
+typedef struct file_job file_job_t;
+
+struct batch {
+    file_job_t      *files;                     /* Files to process */
+    uint32_t        count;                      /* Number of files */
+    uint32_t        next;                       /* Next file to process */
+    uint32_t        failed;                     /* Number of files that failed */
+    int             lagMode;                    /* LAGS_xxx */
+    FILE            *report;                    /* Messages: stdout, or stderr with --stats=- */
+    pthread_mutex_t lock;                       /* Protects next, failed & report */
+};
+
+typedef struct batch batch_t;
 
 /*--------------------------------------------------------------------------
     Error
@@ -95,109 +205,1500 @@ FILE *fcant(const char *fileName, const char *mode)
 
 void Usage(void)
 {
-    printf("Usage: sola <source> <destination> <alpha> [<framesize>]\n");
+    printf("Usage: sola [options] <source> <destination> <alpha> [<framesize>]\n");
+    printf("       sola [options] --batch=<manifest>\n");
+    printf("       sola [options] --glob=<pattern> <directory> <alpha> [<framesize>]\n");
     printf("  source       Specifies the file to be time-scale modified\n");
     printf("  destination  Specifies the filename for the new file\n");
     printf("  alpha        Specifies the time-scale factor [%0.1f to %0.1f]\n", MIN_ALPHA, MAX_ALPHA);
     printf("  framesize    Specifies the size of the overlapping frames\n");
-    printf("               [%u to %u] {default = 160}\n", MIN_FRAMESIZE, MAX_FRAMESIZE);
+    printf("               [%u to %u] {default = 160}, or auto to size them\n", MIN_FRAMESIZE, MAX_FRAMESIZE);
+    printf("               from the pitch of the file\n");
+    printf("  --batch      Processes the files listed in a manifest, one\n");
+    printf("               <source> <destination> <alpha> [<framesize>] per line\n");
+    printf("  --glob       Processes the files matching a pattern into a directory\n");
+    printf("  --jobs       Specifies the number of files (in batch mode) or segments\n");
+    printf("               processed at the same time {default = number of processors}\n");
+    printf("  --segment    Splits the file into segments of about that many samples,\n");
+    printf("               which are processed in parallel and then joined\n");
+    printf("  --lags       Specifies how the channels are synchronized\n");
+    printf("               independent  Each channel finds its own lags {default}\n");
+    printf("               primary      All channels use the lags of the first one\n");
+    printf("               sum          All channels use the lags of their sum\n");
+    printf("  --coarse     Uses a faster, approximate lag search, which tries every\n");
+    printf("               <decimation>th lag and refines the <candidates> best ones\n");
+    printf("               {--coarse=<decimation>[,<candidates>], default = 4,3}\n");
+    printf("  --pitch      Uses a faster, approximate lag search, which tries the lags\n");
+    printf("               within <window> points of the previous one and searches them\n");
+    printf("               all when the best correlation is below <threshold>\n");
+    printf("               {--pitch=<window>[,<threshold>], default = 8,0.7}\n");
+    printf("  --realtime   Processes the input in blocks of that many samples, with\n");
+    printf("               no allocation and a bounded latency per block (the output\n");
+    printf("               is the same)\n");
+    printf("  --schedule   Varies alpha over time, linearly between breakpoints, from\n");
+    printf("               <alpha> at 0 {--schedule=<seconds>:<alpha>[,...]}\n");
+    printf("  --format     Specifies the encoding of the new file {default = that of\n");
+    printf("               the source}: mulaw, alaw or pcm16. A destination ending in\n");
+    printf("               .wav is a RIFF/WAV file, one ending in .au a .au file\n");
+    printf("  --silence    Skips the lag search of the frames whose level is at most\n");
+    printf("               that RMS amplitude [1 to 32767], e.g. 100 for call-center\n");
+    printf("               audio\n");
+    printf("  --stats      Writes timings and counters as JSON to a file\n");
+    printf("               (- = standard output, the messages then go to\n");
+    printf("               the standard error)\n");
 }
 
 /*--------------------------------------------------------------------------
-    Main program
+    Now
+
+    Description:
+        Returns a monotonic time stamp in nanoseconds.
  --------------------------------------------------------------------------*/
 
-void main(int argc, char *argv[])
+uint64_t Now(void)
 {
-    FILE     *srcFile;                          /* File to be time-scale modified */
-    FILE     *destFile;                         /* Destination file */
-    float    alpha;                             /* Time-scale factor */
-    uint16_t frameSize;                         /* Size of the overlapping frames */
-    uint32_t sampleRate;                        /* Samples per seconds */
-    short    *x, *y;
-    uint32_t xSize, ySize;
+    struct timespec ts;
 
-    /*
-     * Display version information.
-     */
-#ifdef VERBOSE
-    PRINT_VERSION_INFO();
-#endif
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+}
+
+/*--------------------------------------------------------------------------
+    Fail
+
+    Description:
+        Records the reason why a file failed.
+
+    Return Value:
+        The error code given.
+ --------------------------------------------------------------------------*/
+
+int Fail(file_job_t *job, int err, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(job->message, sizeof(job->message), fmt, args);
+    va_end(args);
+
+    return job->err = err;
+}
+
+/*--------------------------------------------------------------------------
+    DecodeWindow
+
+    Description:
+        Decodes a window of samples of one channel of a mapped file,
+        or of the downmix of all its channels when channel is 0.
+ --------------------------------------------------------------------------*/
+
+void DecodeWindow(ulaw_map_t *map, uint16_t channel, uint32_t offset, uint32_t count, int16_t window[])
+{
+    int16_t  samples[WINDOW_SIZE];
+    int32_t  sum[WINDOW_SIZE];
+    uint32_t channels, i;
+    uint16_t c;
 
-    if (argc < 4) {
-        Usage();
-        Error("Required parameters missing");
+    if (0 != channel) {
+        ULAW_DecodeMap(map, channel, offset, count, window);
+        return;
     }
 
-    if (argc > 5) {
-        Usage();
-        Error("Too many parameters");
+    ULAW_GetMapInfo(map, NULL, NULL, &channels);
+
+    memset(sum, 0, count * sizeof(int32_t));
+    for (c = 1; c <= channels; c++) {
+        ULAW_DecodeMap(map, c, offset, count, samples);
+        for (i = 0; i < count; i++) sum[i] += samples[i];
     }
+    for (i = 0; i < count; i++) window[i] = (int16_t) (sum[i] / (int32_t) channels);
+}
 
-    /*
-     * Parses the command line string and extracts the required
-     * information.
-     */
-    alpha = (float) atof(argv[3]);
-    if ((alpha < MIN_ALPHA) || (alpha > MAX_ALPHA)) {
-        Error("<alpha> must range from %0.1f to %0.1f", MIN_ALPHA, MAX_ALPHA);
+/*--------------------------------------------------------------------------
+    GetBuffer
+
+    Description:
+        Returns an output buffer of at least size samples, keeping the
+        contents of the given buffer (NULL = a new one). With a pool,
+        the buffer is the one of the channel (slot), which is reused
+        from file to file and only ever grows, so that a worker stops
+        allocating once it has seen its largest file; the pool keeps
+        it, and it must not be freed (see ReleaseBuffer).
+
+    Return Value:
+        The buffer, or NULL if there is not enough memory.
+ --------------------------------------------------------------------------*/
+
+int16_t *GetBuffer(buffer_pool_t *pool, uint32_t slot, int16_t *buffer, size_t size)
+{
+    int16_t *p;
+
+    if (size > (SIZE_MAX / sizeof(int16_t))) {
+        return NULL;
     }
 
-    if (5 == argc) {
-        frameSize = atoi(argv[4]);
-        if ((frameSize < MIN_FRAMESIZE) || (frameSize > MAX_FRAMESIZE)) {
-            Error("<framesize> must range from %u to %u", MIN_FRAMESIZE, MAX_FRAMESIZE);
+    if (NULL == pool) {
+        return (int16_t *) realloc(buffer, size * sizeof(int16_t));
+    }
+
+    if (size > pool->sizes[slot]) {
+        /*
+         * A new buffer has no contents to keep, so it is not copied.
+         */
+        if (NULL == buffer) {
+            free(pool->buffers[slot]);
+            pool->buffers[slot] = NULL;
+            pool->sizes[slot] = 0;
+            p = (int16_t *) malloc(size * sizeof(int16_t));
+        } else {
+            p = (int16_t *) realloc(pool->buffers[slot], size * sizeof(int16_t));
         }
-        SOLA_SetFrameSize(frameSize);
+        if (NULL == p) {
+            return NULL;
+        }
+        pool->buffers[slot] = p;
+        pool->sizes[slot] = size;
     }
 
-    /* 
-     * Perform Time-Scale Modification of speech.
-     */
-#ifdef VERBOSE
-    printf("READING ...\n");
-#endif
-    srcFile = fcant(argv[1], "rb");
-    if (ULAW_ReadFile(1, srcFile, &x, &xSize, &sampleRate)) {
-        Error("Problem reading the file");
+    return pool->buffers[slot];
+}
+
+/*--------------------------------------------------------------------------
+    AdoptBuffer
+
+    Description:
+        Gives the pool a buffer allocated elsewhere (e.g. by
+        SOLA_CtxProcessSegmented) as the buffer of a channel, in place
+        of the one it had. Without a pool, the buffer stays with the
+        caller.
+ --------------------------------------------------------------------------*/
+
+void AdoptBuffer(buffer_pool_t *pool, uint32_t slot, int16_t *buffer, size_t size)
+{
+    if ((NULL != pool) && (buffer != pool->buffers[slot])) {
+        free(pool->buffers[slot]);
+        pool->buffers[slot] = buffer;
+        pool->sizes[slot] = size;
     }
+}
 
-#ifdef VERBOSE
-    printf("PERFORMING Time-Scale Modification (TSM) ...\n");
-#endif
-    if (SOLA_TSM(x, xSize, &y, &ySize, alpha)) {
-        Error("Not enough memory or\nthe size of the original signal is smaller than <framesize = %u>", SOLA_GetFrameSize());
+/*--------------------------------------------------------------------------
+    ReleaseBuffer
+
+    Description:
+        Frees an output buffer, unless it belongs to a pool.
+ --------------------------------------------------------------------------*/
+
+void ReleaseBuffer(buffer_pool_t *pool, int16_t *buffer)
+{
+    if (NULL == pool) {
+        free(buffer);
     }
+}
 
-#ifdef VERBOSE
-    printf("WRITING ...\n");
-#endif
-    destFile = fcant(argv[2], "wb");
-    if (ULAW_SaveFile(destFile, y, ySize, sampleRate)) {
-        free(x);
-        Error("Problem writing the file");
+/*--------------------------------------------------------------------------
+    FreePool
+
+    Description:
+        Frees the buffers of a pool.
+ --------------------------------------------------------------------------*/
+
+void FreePool(buffer_pool_t *pool)
+{
+    uint32_t i;
+
+    for (i = 0; i < MAX_CHANNELS; i++) {
+        free(pool->buffers[i]);
+        pool->buffers[i] = NULL;
+        pool->sizes[i] = 0;
     }
+}
 
-    /*
-     * Free memory blocks that were previously allocated.
-     */
+/*--------------------------------------------------------------------------
+    TimeScaleSegmented
+
+    Description:
+        Time-scale modifies one channel of a mapped file in segments
+        processed in parallel (see SOLA_CtxProcessSegmented). The
+        whole channel is decoded first.
+
+    Return Value:
+        0 on success; otherwise EINVAL if the file is smaller than
+        the frame size, or ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int TimeScaleSegmented(channel_job_t *job)
+{
+    int16_t  *x;
+    uint32_t xSize, offset, count;
+    uint64_t ySize;
+    int      err;
+
+    ULAW_GetMapInfo(job->map, &xSize, NULL, NULL);
+
+    if (NULL == (x = (int16_t *) malloc(((size_t) xSize + 1) * sizeof(int16_t)))) {
+        return ENOMEM;
+    }
+
+    for (offset = 0; offset < xSize; offset += count) {
+        count = ((xSize - offset) < WINDOW_SIZE) ? (xSize - offset) : WINDOW_SIZE;
+        DecodeWindow(job->map, job->channel, offset, count, &x[offset]);
+    }
+
+    err = SOLA_CtxProcessSegmented(job->ctx, x, xSize, &job->y, &ySize, job->alpha, job->segmentSize, job->threads);
     free(x);
-    free(y);
 
-    /*
-     * Display the report
-     */
-    printf("\nSOLA report:\n" );
-    printf("  Time-scale factor:       %0.2f\n", alpha);
-    printf("  Frame size:              %u\n", SOLA_GetFrameSize());
-    printf("  Number of bytes read:    %lu\n", xSize + sizeof(audio_file_header_t));
-    printf("  Number of bytes written: %lu\n", ySize + sizeof(audio_file_header_t));
+    if ((0 == err) && (ySize > UINT32_MAX)) {
+        free(job->y);
+        job->y = NULL;
+        err = ENOMEM;
+    }
+    if (0 == err) {
+        AdoptBuffer(job->pool, job->channel - 1, job->y, (size_t) ySize);
+    }
+    job->ySize = (uint32_t) ySize;
 
-    /*
-     * Close all open streams.
-     */
-    fclose(srcFile);
-    fclose(destFile);
+    return err;
+}
+
+/*--------------------------------------------------------------------------
+    TimeScale
+
+    Description:
+        Time-scale modifies one channel of a mapped file, or the
+        downmix of all its channels when channel is 0. The samples are
+        decoded one window at a time and streamed through the SOLA
+        context, so the input is never copied as a whole; a mono file
+        in 16-bit PCM of the host byte order is streamed straight from
+        the mapping, without decoding (see ULAW_GetMapSamples). In realtime
+        mode, each window is given in blocks of a fixed size (see
+        SOLA_CtxRealtimeBegin).
+
+    Return Value:
+        0 on success; otherwise EINVAL if the file is smaller than
+        the frame size, or ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int TimeScale(channel_job_t *job)
+{
+    sola_ctx_t *ctx = job->ctx;
+    int16_t    window[WINDOW_SIZE];
+    int16_t    *x, *y;
+    const int16_t *samples;                     /* Samples used in place */
+    uint32_t   xSize, ySize, offset, count, n, i, block;
+    int        err;
+
+    if (0 != job->segmentSize) {
+        return TimeScaleSegmented(job);
+    }
+
+    ULAW_GetMapInfo(job->map, &xSize, NULL, NULL);
+
+    if (xSize < SOLA_CtxGetFrameSize(ctx)) {
+        return EINVAL;
+    }
+
+    if (NULL == (y = GetBuffer(job->pool, job->channel - 1U, NULL,
+                               (size_t) ((double) xSize * job->maxAlpha) + SOLA_CtxGetFrameSize(ctx)))) {
+        return ENOMEM;
+    }
+
+    err = (0 != job->blockSize) ? SOLA_CtxRealtimeBegin(ctx, job->alpha, job->blockSize) : SOLA_CtxBegin(ctx, job->alpha);
+    if (0 != err) {
+        ReleaseBuffer(job->pool, y);
+        return err;
+    }
+
+    samples = (0 != job->channel) ? ULAW_GetMapSamples(job->map) : NULL;
+
+    ySize = 0;
+    for (offset = 0; offset < xSize; offset += count) {
+        count = ((xSize - offset) < WINDOW_SIZE) ? (xSize - offset) : WINDOW_SIZE;
+
+        if (NULL != samples) {
+            x = (int16_t *) &samples[offset];   /* Only read by SOLA */
+        } else {
+            DecodeWindow(job->map, job->channel, offset, count, window);
+            x = window;
+        }
+        if (0 == job->blockSize) {
+            err = SOLA_CtxPush(ctx, x, count, &y[ySize], &n);
+            ySize += n;
+        } else {
+            for (i = 0; (i < count) && (0 == err); i += block) {
+                block = ((count - i) < job->blockSize) ? (count - i) : job->blockSize;
+                err = SOLA_CtxRealtimeProcess(ctx, &x[i], block, &y[ySize], &n);
+                ySize += n;
+            }
+        }
+        if (0 != err) {
+            ReleaseBuffer(job->pool, y);
+            return err;
+        }
+    }
+
+    if (0 != (err = SOLA_CtxFlush(ctx, &y[ySize], &n))) {
+        ReleaseBuffer(job->pool, y);
+        return err;
+    }
+    ySize += n;
+
+    job->y = y;
+    job->ySize = ySize;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    ChannelThread
+
+    Description:
+        Worker thread time-scale modifying one channel (see TimeScale).
+ --------------------------------------------------------------------------*/
+
+void *ChannelThread(void *arg)
+{
+    channel_job_t *job = (channel_job_t *) arg;
+
+    job->err = TimeScale(job);
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------
+    RunJobs
+
+    Description:
+        Runs a number of channel jobs and waits for all of them. In
+        parallel, each job has its own thread; otherwise, or for a
+        single job, they run one after the other in the calling
+        thread.
+
+    Return Value:
+        0 if every job succeeded; otherwise the error of the first
+        job that failed. The output of the jobs that succeeded must
+        be freed by the caller in any case.
+ --------------------------------------------------------------------------*/
+
+int RunJobs(channel_job_t jobs[], uint32_t count, int parallel)
+{
+    uint32_t i;
+    int      err = 0;
+
+    for (i = 0; i < count; i++) {
+        jobs[i].y = NULL;
+        jobs[i].err = 0;
+    }
+
+    if (!parallel || (1 == count)) {
+        for (i = 0; (i < count) && (0 == err); i++) {
+            ChannelThread(&jobs[i]);
+            err = jobs[i].err;
+        }
+        return err;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (0 != pthread_create(&jobs[i].thread, NULL, ChannelThread, &jobs[i])) {
+            ChannelThread(&jobs[i]);            /* Out of threads, run it here */
+            jobs[i].thread = pthread_self();
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (!pthread_equal(jobs[i].thread, pthread_self())) {
+            pthread_join(jobs[i].thread, NULL);
+        }
+        if ((0 == err) && (0 != jobs[i].err)) {
+            err = jobs[i].err;
+        }
+    }
+
+    return err;
+}
+
+/*--------------------------------------------------------------------------
+    ChooseFrameSize
+
+    Description:
+        Chooses the frame size of a file from the periods of its
+        signal (the first channel or the downmix), estimated on
+        AUTO_WINDOWS windows spread over the file. With frames of
+        twice a period, the lags cover a whole period, so that a frame
+        can always be aligned on the pitch; longer frames only cost
+        more lags. The frames are sized for the AUTO_PERCENTILE
+        percentile of the periods, so that the few longest ones do not
+        set the size for the whole file.
+
+    Return Value:
+        The frame size; otherwise 0 (the default frame size) when no
+        period was found.
+ --------------------------------------------------------------------------*/
+
+uint16_t ChooseFrameSize(ulaw_map_t *map)
+{
+    int16_t  window[AUTO_WINDOW_SIZE];
+    uint16_t periods[AUTO_WINDOWS], period;
+    uint32_t xSize, channels, count = 0, i, j;
+    uint32_t frameSize;
+
+    ULAW_GetMapInfo(map, &xSize, NULL, &channels);
+
+    if (xSize < AUTO_WINDOW_SIZE) {
+        return 0;
+    }
+
+    for (i = 0; i < AUTO_WINDOWS; i++) {
+        DecodeWindow(map, (uint16_t) ((1 == channels) ? 1 : 0),
+                     (uint32_t) ((uint64_t) (xSize - AUTO_WINDOW_SIZE) * i / (AUTO_WINDOWS - 1)), AUTO_WINDOW_SIZE, window);
+        period = SOLA_EstimatePeriod(window, AUTO_WINDOW_SIZE, MIN_FRAMESIZE / 2, MAX_FRAMESIZE / 2, AUTO_THRESHOLD);
+        if (0 == period) {
+            continue;
+        }
+
+        /*
+         * Insert the period in order.
+         */
+        for (j = count++; (j > 0) && (periods[j - 1] > period); j--) {
+            periods[j] = periods[j - 1];
+        }
+        periods[j] = period;
+    }
+
+    if (0 == count) {
+        return 0;
+    }
+
+    frameSize = 2U * periods[(count - 1) * AUTO_PERCENTILE / 100U];
+    if (frameSize < MIN_FRAMESIZE) frameSize = MIN_FRAMESIZE;
+    if (frameSize > MAX_FRAMESIZE) frameSize = MAX_FRAMESIZE;
+
+    return (uint16_t) frameSize;
+}
+
+/*--------------------------------------------------------------------------
+    AddFrameCounts
+
+    Description:
+        Adds the frame counts of a context (see SOLA_CtxGetFrameCounts)
+        to those of a file.
+ --------------------------------------------------------------------------*/
+
+void AddFrameCounts(file_job_t *job, sola_ctx_t *ctx)
+{
+    uint64_t frames, silentFrames;
+
+    if (NULL != ctx) {
+        SOLA_CtxGetFrameCounts(ctx, &frames, &silentFrames);
+        job->frames += frames;
+        job->silentFrames += silentFrames;
+    }
+}
+
+/*--------------------------------------------------------------------------
+    TimeScaleChannels
+
+    Description:
+        Time-scale modifies all the channels of a mapped file, each
+        with its own SOLA context. With shared lags, the lags are first
+        found on the reference channel (the first channel, or the sum
+        of all of them), and then applied to the other channels. The
+        times of the alpha schedule, if any, are converted to samples;
+        the schedule starts from alpha when it has no breakpoint at 0.
+        An automatic frame size is chosen here (see ChooseFrameSize).
+        Channels that found their own lags may end at slightly
+        different points; the shorter ones are padded with silence.
+
+    Parameters:
+        job - File being processed
+        map - Mapped source file
+        lagMode - LAGS_xxx
+        parallel - Nonzero to process the channels on worker threads
+        y - Receives the synthetic signal of each channel
+        ySize - Number of samples per channel (pointer)
+
+    Return Value:
+        0 on success; otherwise an error code (see Fail).
+ --------------------------------------------------------------------------*/
+
+int TimeScaleChannels(file_job_t *job, ulaw_map_t *map, int lagMode, int parallel, int16_t *y[], uint32_t *ySize)
+{
+    channel_job_t *jobs;                        /* One job per channel */
+    channel_job_t ref;                          /* Reference channel of the lags */
+    int16_t       *lags = NULL;                 /* Shared lags */
+    int16_t       *padded;
+    sola_breakpoint_t *points = NULL;           /* Schedule, in samples */
+    uint32_t      channels = job->channels, xSize, sampleRate, count = 0, i;
+    uint64_t      lagCount = 0;
+    uint16_t      frameSize = job->frameSize;
+    float         maxAlpha = job->alpha;
+    int           err = 0;
+
+    ULAW_GetMapInfo(map, &xSize, &sampleRate, NULL);
+
+    if (AUTO_FRAMESIZE == frameSize) {
+        frameSize = ChooseFrameSize(map);
+    }
+
+    if (NULL == (jobs = (channel_job_t *) calloc(channels, sizeof(channel_job_t)))) {
+        return Fail(job, ENOMEM, "Not enough memory");
+    }
+    memset(&ref, 0, sizeof(ref));
+
+    if (NULL != job->schedule) {
+        if (NULL == (points = (sola_breakpoint_t *) malloc((job->points + 1) * sizeof(sola_breakpoint_t)))) {
+            free(jobs);
+            return Fail(job, ENOMEM, "Not enough memory");
+        }
+        if (job->schedule[0].time > 0.0) {
+            points[count].position = 0;
+            points[count++].alpha = job->alpha;
+        }
+        for (i = 0; i < job->points; i++, count++) {
+            points[count].position = (uint64_t) (job->schedule[i].time * sampleRate + 0.5);
+            points[count].alpha = job->schedule[i].alpha;
+            if (points[count].alpha > maxAlpha) maxAlpha = points[count].alpha;
+        }
+    }
+
+    for (i = 0; (i <= channels) && (0 == err); i++) {
+        channel_job_t *cjob = (i < channels) ? &jobs[i] : &ref;
+
+        if (0 != (err = SOLA_CtxCreate(&cjob->ctx))) {
+            break;
+        }
+        if (0 != frameSize) {
+            SOLA_CtxSetFrameSize(cjob->ctx, frameSize);
+        }
+        if (0 != job->decimation) {
+            SOLA_CtxSetSearchMethod(cjob->ctx, SOLA_SEARCH_COARSE);
+            SOLA_CtxSetCoarseSearch(cjob->ctx, job->decimation, job->candidates);
+        }
+        if (0 != job->window) {
+            SOLA_CtxSetSearchMethod(cjob->ctx, SOLA_SEARCH_PITCH);
+            SOLA_CtxSetPitchSearch(cjob->ctx, job->window, job->threshold);
+        }
+        SOLA_CtxSetSilenceThreshold(cjob->ctx, job->silence);
+        if (job->stats) {
+            SOLA_CtxSetStats(cjob->ctx, &cjob->stats);
+        }
+        if (NULL != points) {
+            SOLA_CtxSetSchedule(cjob->ctx, points, count);
+        }
+        cjob->map = map;
+        cjob->channel = (uint16_t) ((i < channels) ? (i + 1) : 0);
+        cjob->alpha = job->alpha;
+        cjob->maxAlpha = maxAlpha;
+        cjob->segmentSize = job->segmentSize;
+        cjob->threads = job->threads;
+        cjob->blockSize = job->blockSize;
+        cjob->pool = (i < channels) ? job->pool : NULL;
+    }
+
+    if ((0 == err) && (channels > 1) && (LAGS_INDEPENDENT != lagMode)) {
+        lagCount = SOLA_CtxGetLagCount(ref.ctx, xSize, job->alpha);
+        if (NULL == (lags = (int16_t *) malloc((size_t) (lagCount + 1) * sizeof(int16_t)))) {
+            err = ENOMEM;
+        }
+    }
+
+    if ((0 == err) && (NULL != lags)) {
+        if (LAGS_PRIMARY == lagMode) {
+            SOLA_CtxSetLagTrack(jobs[0].ctx, SOLA_LAGS_RECORD, lags, lagCount);
+            err = RunJobs(jobs, 1, parallel);
+        } else {
+            SOLA_CtxSetLagTrack(ref.ctx, SOLA_LAGS_RECORD, lags, lagCount);
+            err = RunJobs(&ref, 1, parallel);
+            free(ref.y);
+        }
+        for (i = (LAGS_PRIMARY == lagMode) ? 1 : 0; i < channels; i++) {
+            SOLA_CtxSetLagTrack(jobs[i].ctx, SOLA_LAGS_APPLY, lags, lagCount);
+        }
+    }
+
+    if ((0 == err) && (LAGS_PRIMARY == lagMode) && (NULL != lags)) {
+        err = RunJobs(&jobs[1], channels - 1, parallel);
+    } else if (0 == err) {
+        err = RunJobs(jobs, channels, parallel);
+    }
+
+    if (NULL != ref.ctx) {
+        frameSize = SOLA_CtxGetFrameSize(ref.ctx);
+    }
+    job->usedFrameSize = frameSize;
+
+    for (i = 0; i < channels; i++) {
+        SOLA_AddStats(&job->tsmStats, &jobs[i].stats);
+        AddFrameCounts(job, jobs[i].ctx);
+    }
+    SOLA_AddStats(&job->tsmStats, &ref.stats);
+    AddFrameCounts(job, ref.ctx);
+
+    *ySize = 0;
+    for (i = 0; i < channels; i++) {
+        if ((0 == err) && (jobs[i].ySize > *ySize)) *ySize = jobs[i].ySize;
+    }
+    for (i = 0; i < channels; i++) {
+        y[i] = jobs[i].y;
+        if ((0 == err) && (jobs[i].ySize < *ySize)) {
+            if (NULL == (padded = GetBuffer(job->pool, i, y[i], *ySize))) {
+                err = ENOMEM;
+            } else {
+                y[i] = padded;
+                memset(&y[i][jobs[i].ySize], 0, (*ySize - jobs[i].ySize) * sizeof(int16_t));
+            }
+        }
+        SOLA_CtxDestroy(jobs[i].ctx);
+    }
+    for (i = 0; (i < channels) && (0 != err); i++) {
+        ReleaseBuffer(job->pool, y[i]);
+        y[i] = NULL;
+    }
+    SOLA_CtxDestroy(ref.ctx);
+    free(jobs);
+    free(lags);
+    free(points);
+
+    if (EINVAL == err) {
+        return Fail(job, err, "The size of the original signal is smaller than <framesize = %u>", frameSize);
+    } else if (0 != err) {
+        return Fail(job, err, "Not enough memory");
+    }
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    GetContainer
+
+    Description:
+        Returns the container of a destination file from its
+        extension (.wav or .au), or the given container for any other
+        extension.
+ --------------------------------------------------------------------------*/
+
+int GetContainer(const char *fileName, int container)
+{
+    const char *extension = strrchr(fileName, '.');
+
+    if ((NULL == extension) || (NULL != strchr(extension, '/'))) {
+        return container;
+    }
+    if (0 == strcasecmp(extension, ".wav")) {
+        return ULAW_CONTAINER_WAV;
+    }
+    if ((0 == strcasecmp(extension, ".au")) || (0 == strcasecmp(extension, ".snd"))) {
+        return ULAW_CONTAINER_AU;
+    }
+
+    return container;
+}
+
+/*--------------------------------------------------------------------------
+    ConvertFile
+
+    Description:
+        Maps the source file of a job, time-scale modifies its channels
+        and writes the destination file (see ProcessFile). The new file
+        keeps the encoding and the container of the source, unless the
+        job or the extension of the destination says otherwise.
+ --------------------------------------------------------------------------*/
+
+int ConvertFile(file_job_t *job, int lagMode, int parallel)
+{
+    FILE       *srcFile;                        /* File to be time-scale modified */
+    FILE       *destFile;                       /* Destination file */
+    ulaw_map_t *map;                            /* Memory-mapped source file */
+    int16_t    **y;                             /* Output of each channel */
+    uint32_t   sampleRate;                      /* Samples per seconds */
+    uint32_t   format, dataLocation;            /* Encoding of the source */
+    int        container;                       /* Container of the source */
+    uint32_t   xSize, ySize, written, i;
+    int        err;
+
+    if ((job->alpha < MIN_ALPHA) || (job->alpha > MAX_ALPHA)) {
+        return Fail(job, EINVAL, "<alpha> must range from %0.1f to %0.1f", MIN_ALPHA, MAX_ALPHA);
+    }
+
+    if ((0 != job->frameSize) && (AUTO_FRAMESIZE != job->frameSize) &&
+        ((job->frameSize < MIN_FRAMESIZE) || (job->frameSize > MAX_FRAMESIZE))) {
+        return Fail(job, EINVAL, "<framesize> must range from %u to %u", MIN_FRAMESIZE, MAX_FRAMESIZE);
+    }
+
+    if (NULL == (srcFile = fopen(job->source, "rb"))) {
+        return Fail(job, errno, "Can't open %s", job->source);
+    }
+
+    if (0 != (err = ULAW_MapFile(srcFile, &map))) {
+        fclose(srcFile);
+        return Fail(job, err, "Problem reading the file");
+    }
+    ULAW_GetMapInfo(map, &xSize, &sampleRate, &job->channels);
+    ULAW_GetMapFormat(map, &format, &container, &dataLocation);
+    job->bytesRead = (uint64_t) xSize * job->channels * ULAW_SAMPLE_SIZE(format) + dataLocation;
+
+    if (job->channels > MAX_CHANNELS) {
+        ULAW_UnmapFile(map);
+        fclose(srcFile);
+        return Fail(job, EINVAL, "The file has more than %u channels", MAX_CHANNELS);
+    }
+
+    if (NULL == (y = (int16_t **) calloc(job->channels, sizeof(int16_t *)))) {
+        ULAW_UnmapFile(map);
+        fclose(srcFile);
+        return Fail(job, ENOMEM, "Not enough memory");
+    }
+
+    err = TimeScaleChannels(job, map, lagMode, parallel, y, &ySize);
+    ULAW_UnmapFile(map);
+    fclose(srcFile);
+    if (0 != err) {
+        free(y);
+        return err;
+    }
+
+    if (NULL == (destFile = fopen(job->destination, "wb"))) {
+        err = Fail(job, errno, "Can't open %s", job->destination);
+    } else {
+        if (0 != job->format) {
+            format = job->format;
+        }
+        container = GetContainer(job->destination, container);
+        if (0 != (err = ULAW_SaveChannelsAs(destFile, y, (uint16_t) job->channels, ySize, sampleRate, format, container,
+                                            ((uint64_t) ySize * job->channels >= LARGE_OUTPUT) ? (ULAW_WRITE_SEQUENTIAL | ULAW_WRITE_DONTNEED) : ULAW_WRITE_DEFAULT,
+                                            &written))) {
+            Fail(job, err, "Problem writing the file (%u of %u samples written)", written, ySize);
+        }
+        if ((0 != fclose(destFile)) && (0 == err)) {
+            err = Fail(job, EIO, "Problem writing the file");
+        }
+        job->bytesWritten = (uint64_t) ySize * job->channels * ULAW_SAMPLE_SIZE(format) +
+                            ((ULAW_CONTAINER_WAV == container) ? WAV_FILE_HEADER_SIZE : sizeof(audio_file_header_t));
+    }
+
+    for (i = 0; i < job->channels; i++) {
+        ReleaseBuffer(job->pool, y[i]);
+    }
+    free(y);
+
+    return err;
+}
+
+/*--------------------------------------------------------------------------
+    ProcessFile
+
+    Description:
+        Time-scale modifies one file. Nothing is displayed and the
+        program never exits from here, so that files can be processed
+        concurrently; the outcome is left in the job.
+
+    Parameters:
+        job - File to process
+        lagMode - LAGS_xxx
+        parallel - Nonzero to process the channels on worker threads
+
+    Return Value:
+        0 on success; otherwise an error code, with the reason in
+        job->message.
+ --------------------------------------------------------------------------*/
+
+int ProcessFile(file_job_t *job, int lagMode, int parallel)
+{
+    uint64_t start = Now();
+    int      err;
+
+    job->err = 0;
+    job->message[0] = '\0';
+    job->channels = 0;
+    job->bytesRead = job->bytesWritten = 0;
+    job->frames = job->silentFrames = 0;
+    memset(&job->tsmStats, 0, sizeof(job->tsmStats));
+    memset(&job->ioStats, 0, sizeof(job->ioStats));
+
+    /*
+     * The I/O statistics are per thread, and the map takes them along
+     * to the threads of the channels.
+     */
+    ULAW_SetStats(job->stats ? &job->ioStats : NULL);
+    err = ConvertFile(job, lagMode, parallel);
+    ULAW_SetStats(NULL);
+
+    job->wallTime = Now() - start;
+
+    return err;
+}
+
+/*--------------------------------------------------------------------------
+    AddFile
+
+    Description:
+        Appends a file to the list of files of a batch.
+
+    Return Value:
+        0 on success; otherwise ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int AddFile(batch_t *batch, const char *source, const char *destination, float alpha, uint16_t frameSize)
+{
+    file_job_t *files;
+
+    if (NULL == (files = (file_job_t *) realloc(batch->files, (batch->count + 1) * sizeof(file_job_t)))) {
+        return ENOMEM;
+    }
+    batch->files = files;
+
+    files = &batch->files[batch->count];
+    memset(files, 0, sizeof(file_job_t));
+    files->source = strdup(source);
+    files->destination = strdup(destination);
+    files->alpha = alpha;
+    files->frameSize = frameSize;
+    if ((NULL == files->source) || (NULL == files->destination)) {
+        free(files->source);
+        free(files->destination);
+        return ENOMEM;
+    }
+
+    batch->count++;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    ReadManifest
+
+    Description:
+        Reads the list of files of a batch from a manifest. Each line
+        holds <source> <destination> <alpha> [<framesize> | auto],
+        separated by blanks. Blank lines and lines starting with '#' are
+        ignored. A malformed line is added as a file that failed, so it
+        is reported with the others and the rest of the batch still
+        runs.
+ --------------------------------------------------------------------------*/
+
+void ReadManifest(batch_t *batch, const char *fileName)
+{
+    FILE     *stream;
+    char     line[2 * PATH_MAX + 64];
+    char     source[PATH_MAX], destination[PATH_MAX], size[16], extra, *p;
+    float    alpha;
+    unsigned frameSize;
+    int      fields, valid;
+    uint32_t lineNumber = 0;
+
+    stream = fcant(fileName, "r");
+
+    while (NULL != fgets(line, sizeof(line), stream)) {
+        lineNumber++;
+
+        for (p = line; (' ' == *p) || ('\t' == *p); p++)
+            ;
+        if (('\0' == *p) || ('\n' == *p) || ('\r' == *p) || ('#' == *p)) {
+            continue;
+        }
+
+        frameSize = 0;
+        destination[0] = '\0';
+        fields = sscanf(p, "%4095s %4095s %f %15s", source, destination, &alpha, size);
+        valid = (fields >= 3);
+        if (4 == fields) {
+            if (0 == strcmp(size, "auto")) {
+                frameSize = AUTO_FRAMESIZE;
+            } else if ((1 != sscanf(size, "%u%c", &frameSize, &extra)) || (frameSize >= AUTO_FRAMESIZE)) {
+                valid = 0;
+            }
+        }
+        if (!valid) {
+            alpha = 0.0F;
+            frameSize = 0;
+        }
+
+        if (0 != AddFile(batch, source, destination, alpha, (uint16_t) frameSize)) {
+            Error("Not enough memory");
+        }
+        if (!valid) {
+            Fail(&batch->files[batch->count - 1], EINVAL,
+                 "%s, line %u: expected <source> <destination> <alpha> [<framesize> | auto]", fileName, lineNumber);
+        }
+    }
+
+    fclose(stream);
+}
+
+/*--------------------------------------------------------------------------
+    ExpandGlob
+
+    Description:
+        Builds the list of files of a batch from the files matching a
+        pattern. Each file is written to the destination directory
+        under the same name.
+ --------------------------------------------------------------------------*/
+
+void ExpandGlob(batch_t *batch, const char *pattern, const char *directory, float alpha, uint16_t frameSize)
+{
+    glob_t   matches;
+    char     destination[PATH_MAX], name[PATH_MAX];
+    size_t   i;
+
+    if (0 != glob(pattern, 0, NULL, &matches)) {
+        Error("No file matches %s", pattern);
+    }
+
+    for (i = 0; i < matches.gl_pathc; i++) {
+        strncpy(name, matches.gl_pathv[i], sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        if ((int) sizeof(destination) <= snprintf(destination, sizeof(destination), "%s/%s", directory, basename(name))) {
+            Error("Path too long: %s/%s", directory, basename(name));
+        }
+        if (0 != AddFile(batch, matches.gl_pathv[i], destination, alpha, frameSize)) {
+            Error("Not enough memory");
+        }
+    }
+
+    globfree(&matches);
+}
+
+/*--------------------------------------------------------------------------
+    BatchThread
+
+    Description:
+        Worker thread of the batch mode. It takes the next file of the
+        batch until there are none left, and reports the status of
+        each file as soon as it is done. The output buffers are kept
+        from one file to the next (see GetBuffer).
+ --------------------------------------------------------------------------*/
+
+void *BatchThread(void *arg)
+{
+    batch_t       *batch = (batch_t *) arg;
+    file_job_t    *job;
+    buffer_pool_t pool;
+
+    memset(&pool, 0, sizeof(pool));
+
+    for (;;) {
+        pthread_mutex_lock(&batch->lock);
+        job = (batch->next < batch->count) ? &batch->files[batch->next++] : NULL;
+        pthread_mutex_unlock(&batch->lock);
+
+        if (NULL == job) {
+            break;
+        }
+
+        /*
+         * The files already keep the workers busy, so the channels of
+         * a file are processed one after the other. A file that failed
+         * already (a malformed line of the manifest) is only reported.
+         */
+        if (0 == job->err) {
+            job->pool = &pool;
+            ProcessFile(job, batch->lagMode, 0);
+            job->pool = NULL;
+        }
+
+        pthread_mutex_lock(&batch->lock);
+        if (0 == job->err) {
+            fprintf(batch->report, "OK      %s -> %s\n", job->source, job->destination);
+        } else {
+            fprintf(batch->report, "FAILED  %s: %s\n", job->source, job->message);
+            batch->failed++;
+        }
+        fflush(batch->report);
+        pthread_mutex_unlock(&batch->lock);
+    }
+
+    FreePool(&pool);
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------
+    RunBatch
+
+    Description:
+        Processes the files of a batch on a pool of worker threads.
+
+    Return Value:
+        Number of files that failed.
+ --------------------------------------------------------------------------*/
+
+uint32_t RunBatch(batch_t *batch, uint32_t workers)
+{
+    pthread_t *threads;
+    uint32_t  i, started = 0;
+
+    if (workers > batch->count) workers = batch->count;
+
+    if (NULL == (threads = (pthread_t *) malloc((workers + 1) * sizeof(pthread_t)))) {
+        Error("Not enough memory");
+    }
+
+    for (i = 0; i < workers; i++) {
+        if (0 == pthread_create(&threads[started], NULL, BatchThread, batch)) {
+            started++;
+        }
+    }
+
+    if (0 == started) {
+        BatchThread(batch);                     /* Out of threads, run it here */
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(threads);
+
+    return batch->failed;
+}
+
+/*--------------------------------------------------------------------------
+    PrintString
+
+    Description:
+        Prints a string as a JSON string.
+ --------------------------------------------------------------------------*/
+
+void PrintString(FILE *stream, const char *string)
+{
+    const unsigned char *p;
+
+    fputc('"', stream);
+    for (p = (const unsigned char *) string; '\0' != *p; p++) {
+        if (('"' == *p) || ('\\' == *p)) {
+            fprintf(stream, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(stream, "\\u%04x", *p);
+        } else {
+            fputc(*p, stream);
+        }
+    }
+    fputc('"', stream);
+}
+
+/*--------------------------------------------------------------------------
+    PrintStats
+
+    Description:
+        Prints the statistics of a file as a JSON object. The times are
+        in nanoseconds; those of the channels, which may run at the
+        same time, add up. The lags from -N/2 to N/2 are counted in
+        SOLA_KM_BINS bins of equal width.
+ --------------------------------------------------------------------------*/
+
+void PrintStats(FILE *stream, file_job_t *job)
+{
+    sola_stats_t *tsm = &job->tsmStats;
+    ulaw_stats_t *io = &job->ioStats;
+    int          i;
+
+    fprintf(stream, "    {\n      \"source\": ");
+    PrintString(stream, job->source);
+    fprintf(stream, ",\n      \"destination\": ");
+    PrintString(stream, job->destination);
+    fprintf(stream, ",\n      \"status\": \"%s\",\n", (0 == job->err) ? "ok" : "failed");
+    if (0 != job->err) {
+        fprintf(stream, "      \"error\": ");
+        PrintString(stream, job->message);
+        fprintf(stream, ",\n");
+    }
+    fprintf(stream, "      \"alpha\": %0.2f,\n", job->alpha);
+    fprintf(stream, "      \"framesize\": %u,\n", job->usedFrameSize);
+    fprintf(stream, "      \"channels\": %u,\n", job->channels);
+    fprintf(stream, "      \"wall_ns\": %" PRIu64 ",\n", job->wallTime);
+    fprintf(stream, "      \"read\": { \"bytes\": %" PRIu64 ", \"wall_ns\": %" PRIu64 ", \"cpu_ns\": %" PRIu64 " },\n",
+            io->bytesRead, io->readWallTime, io->readCpuTime);
+    fprintf(stream, "      \"tsm\": {\n");
+    fprintf(stream, "        \"wall_ns\": %" PRIu64 ",\n", tsm->wallTime);
+    fprintf(stream, "        \"cpu_ns\": %" PRIu64 ",\n", tsm->cpuTime);
+    fprintf(stream, "        \"frames\": %" PRIu64 ",\n", tsm->frames);
+    fprintf(stream, "        \"lag_evaluations\": %" PRIu64 ",\n", tsm->lagEvaluations);
+    fprintf(stream, "        \"early_exits\": %" PRIu64 ",\n", tsm->earlyExits);
+    fprintf(stream, "        \"applied_lags\": %" PRIu64 ",\n", tsm->appliedLags);
+    fprintf(stream, "        \"widened_searches\": %" PRIu64 ",\n", tsm->widenedSearches);
+    fprintf(stream, "        \"silent_frames\": %" PRIu64 ",\n", tsm->silentFrames);
+    fprintf(stream, "        \"max_block_ns\": %" PRIu64 ",\n", tsm->maxBlockTime);
+    fprintf(stream, "        \"km_histogram\": { \"min\": %d, \"max\": %d, \"counts\": [",
+            -(job->usedFrameSize / 2), job->usedFrameSize / 2);
+    for (i = 0; i < SOLA_KM_BINS; i++) {
+        fprintf(stream, "%s%" PRIu64, (0 == i) ? " " : ", ", tsm->kmHistogram[i]);
+    }
+    fprintf(stream, " ] }\n      },\n");
+    fprintf(stream, "      \"write\": { \"bytes\": %" PRIu64 ", \"wall_ns\": %" PRIu64 ", \"cpu_ns\": %" PRIu64 " }\n",
+            io->bytesWritten, io->writeWallTime, io->writeCpuTime);
+    fprintf(stream, "    }");
+}
+
+/*--------------------------------------------------------------------------
+    WriteStats
+
+    Description:
+        Writes the statistics of the files of a batch as JSON, to a
+        file or to the standard output ("-").
+ --------------------------------------------------------------------------*/
+
+void WriteStats(const char *fileName, batch_t *batch)
+{
+    FILE     *stream;
+    uint32_t i;
+
+    stream = (0 == strcmp(fileName, "-")) ? stdout : fcant(fileName, "w");
+
+    fprintf(stream, "{\n  \"version\": \"%d.%d%c\",\n  \"files\": [\n", VER_MAJOR, VER_MINOR, VER_REVISION);
+    for (i = 0; i < batch->count; i++) {
+        PrintStats(stream, &batch->files[i]);
+        fprintf(stream, "%s\n", (i < (batch->count - 1)) ? "," : "");
+    }
+    fprintf(stream, "  ]\n}\n");
+
+    if (stdout == stream) {
+        fflush(stream);
+    } else if (0 != fclose(stream)) {
+        Error("Problem writing %s", fileName);
+    }
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+void main(int argc, char *argv[])
+{
+    static struct option options[] = {
+        { "lags",     required_argument, NULL, 'l' },
+        { "batch",    required_argument, NULL, 'b' },
+        { "glob",     required_argument, NULL, 'g' },
+        { "jobs",     required_argument, NULL, 'j' },
+        { "segment",  required_argument, NULL, 's' },
+        { "stats",    required_argument, NULL, 't' },
+        { "coarse",   optional_argument, NULL, 'c' },
+        { "pitch",    optional_argument, NULL, 'p' },
+        { "realtime", required_argument, NULL, 'r' },
+        { "schedule", required_argument, NULL, 'a' },
+        { "format",   required_argument, NULL, 'f' },
+        { "silence",  required_argument, NULL, 'q' },
+        { NULL,       0,                 NULL, 0   }
+    };
+
+    batch_t    batch;                           /* Files to process */
+    file_job_t *job;
+    const char *manifest = NULL;                /* --batch */
+    const char *pattern = NULL;                 /* --glob */
+    long       workers;                         /* --jobs */
+    long long  segmentSize = 0;                 /* --segment */
+    long       blockSize = 0;                   /* --realtime */
+    breakpoint_t schedule[MAX_BREAKPOINTS];     /* --schedule */
+    uint32_t   points = 0;
+    char       *item;
+    const char *statsFile = NULL;               /* --stats */
+    uint32_t   format = 0;                      /* --format */
+    unsigned   decimation = 0, candidates = 3;  /* --coarse */
+    unsigned   window = 0;                      /* --pitch */
+    long       silence = 0;                     /* --silence */
+    float      threshold = 0.7F;
+    float      alpha = 0.0F;                    /* Time-scale factor */
+    uint16_t   frameSize = 0;                   /* Size of the overlapping frames */
+    uint64_t   frames, silentFrames;
+    uint32_t   i, failed;
+    int        opt, arg;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.lagMode = LAGS_INDEPENDENT;
+    workers = sysconf(_SC_NPROCESSORS_ONLN);
+
+    while (-1 != (opt = getopt_long(argc, argv, "", options, NULL))) {
+        switch (opt) {
+        case 'l':
+            if (0 == strcmp(optarg, "independent")) {
+                batch.lagMode = LAGS_INDEPENDENT;
+            } else if (0 == strcmp(optarg, "primary")) {
+                batch.lagMode = LAGS_PRIMARY;
+            } else if (0 == strcmp(optarg, "sum")) {
+                batch.lagMode = LAGS_SUM;
+            } else {
+                Error("--lags must be independent, primary or sum");
+            }
+            break;
+
+        case 'b':
+            manifest = optarg;
+            break;
+
+        case 'g':
+            pattern = optarg;
+            break;
+
+        case 'j':
+            workers = atol(optarg);
+            if ((workers < 1) || (workers > MAX_JOBS)) {
+                Error("--jobs must range from 1 to %u", MAX_JOBS);
+            }
+            break;
+
+        case 's':
+            segmentSize = atoll(optarg);
+            if (segmentSize < 1) {
+                Error("--segment must be a number of samples");
+            }
+            break;
+
+        case 't':
+            statsFile = optarg;
+            break;
+
+        case 'a':
+            for (item = strtok(optarg, ","); NULL != item; item = strtok(NULL, ",")) {
+                if ((MAX_BREAKPOINTS == points) ||
+                    (2 != sscanf(item, "%lf:%f", &schedule[points].time, &schedule[points].alpha)) ||
+                    (schedule[points].time < 0.0) || ((points > 0) && (schedule[points].time < schedule[points - 1].time)) ||
+                    (schedule[points].alpha < MIN_ALPHA) || (schedule[points].alpha > MAX_ALPHA)) {
+                    Error("--schedule must be up to %u <seconds>:<alpha> by increasing time, alpha from %0.1f to %0.1f",
+                          MAX_BREAKPOINTS, MIN_ALPHA, MAX_ALPHA);
+                }
+                points++;
+            }
+            break;
+
+        case 'f':
+            if (0 == strcmp(optarg, "mulaw")) {
+                format = ULAW_FORMAT_MULAW;
+            } else if (0 == strcmp(optarg, "alaw")) {
+                format = ULAW_FORMAT_ALAW;
+            } else if (0 == strcmp(optarg, "pcm16")) {
+                format = ULAW_FORMAT_PCM16;
+            } else {
+                Error("--format must be mulaw, alaw or pcm16");
+            }
+            break;
+
+        case 'q':
+            silence = atol(optarg);
+            if ((silence < 1) || (silence > INT16_MAX)) {
+                Error("--silence must range from 1 to %d", INT16_MAX);
+            }
+            break;
+
+        case 'r':
+            blockSize = atol(optarg);
+            if ((blockSize < 1) || (blockSize > WINDOW_SIZE)) {
+                Error("--realtime must range from 1 to %u samples", WINDOW_SIZE);
+            }
+            break;
+
+        case 'c':
+            decimation = 4;
+            if ((NULL != optarg) &&
+                ((sscanf(optarg, "%u,%u", &decimation, &candidates) < 1) ||
+                 (decimation < 2) || (decimation > SOLA_MAX_DECIMATION) ||
+                 (candidates < 1) || (candidates > SOLA_MAX_CANDIDATES))) {
+                Error("--coarse must be <decimation>[,<candidates>], from 2 to %u and 1 to %u",
+                      SOLA_MAX_DECIMATION, SOLA_MAX_CANDIDATES);
+            }
+            break;
+
+        case 'p':
+            window = 8;
+            if ((NULL != optarg) &&
+                ((sscanf(optarg, "%u,%f", &window, &threshold) < 1) ||
+                 (window < 1) || (window > MAX_FRAMESIZE) || !((threshold >= 0.0F) && (threshold <= 1.0F)))) {
+                Error("--pitch must be <window>[,<threshold>], from 1 to %u and 0 to 1", MAX_FRAMESIZE);
+            }
+            break;
+
+        default:
+            Usage();
+            Error("Invalid option");
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    /*
+     * With --stats=-, the standard output only carries the JSON
+     * statistics, and the messages go to the standard error.
+     */
+    batch.report = ((NULL != statsFile) && (0 == strcmp(statsFile, "-"))) ? stderr : stdout;
+
+    /*
+     * Display version information.
+     */
+#ifdef VERBOSE
+    PRINT_VERSION_INFO(batch.report);
+#endif
+
+    if ((NULL != manifest) && (NULL != pattern)) {
+        Error("--batch and --glob can't be used together");
+    }
+
+    if ((0 != segmentSize) && ((NULL != manifest) || (NULL != pattern))) {
+        Error("--segment can't be used in batch mode");
+    }
+
+    if ((0 != segmentSize) && (LAGS_INDEPENDENT != batch.lagMode)) {
+        Error("--segment can't be used with shared lags");
+    }
+
+    if ((0 != segmentSize) && (0 != points)) {
+        Error("--segment and --schedule can't be used together");
+    }
+
+    if ((0 != segmentSize) && (0 != blockSize)) {
+        Error("--segment and --realtime can't be used together");
+    }
+
+    if ((0 != decimation) && (0 != window)) {
+        Error("--coarse and --pitch can't be used together");
+    }
+
+    /*
+     * A manifest holds all the parameters; otherwise, they are on the
+     * command line.
+     */
+    if (NULL != manifest) {
+        if (argc > 1) {
+            Usage();
+            Error("Too many parameters");
+        }
+    } else {
+        /*
+         * With --glob, the destination directory replaces both file
+         * names.
+         */
+        arg = (NULL != pattern) ? 2 : 3;
+
+        if (argc < (arg + 1)) {
+            Usage();
+            Error("Required parameters missing");
+        }
+
+        if (argc > (arg + 2)) {
+            Usage();
+            Error("Too many parameters");
+        }
+
+        /*
+         * Parses the command line string and extracts the required
+         * information.
+         */
+        alpha = (float) atof(argv[arg]);
+        if ((alpha < MIN_ALPHA) || (alpha > MAX_ALPHA)) {
+            Error("<alpha> must range from %0.1f to %0.1f", MIN_ALPHA, MAX_ALPHA);
+        }
+
+        if (((arg + 2) == argc) && (0 == strcmp(argv[arg + 1], "auto"))) {
+            frameSize = AUTO_FRAMESIZE;
+        } else if ((arg + 2) == argc) {
+            frameSize = atoi(argv[arg + 1]);
+            if ((frameSize < MIN_FRAMESIZE) || (frameSize > MAX_FRAMESIZE)) {
+                Error("<framesize> must range from %u to %u", MIN_FRAMESIZE, MAX_FRAMESIZE);
+            }
+        }
+    }
+
+    /*
+     * Batch mode.
+     */
+    if ((NULL != manifest) || (NULL != pattern)) {
+        if (NULL != manifest) {
+            ReadManifest(&batch, manifest);
+        } else {
+            ExpandGlob(&batch, pattern, argv[1], alpha, frameSize);
+        }
+        pthread_mutex_init(&batch.lock, NULL);
+
+        for (i = 0; i < batch.count; i++) {
+            batch.files[i].stats = (NULL != statsFile);
+            batch.files[i].silence = (uint16_t) silence;
+            batch.files[i].decimation = (uint16_t) decimation;
+            batch.files[i].candidates = (uint16_t) candidates;
+            batch.files[i].window = (uint16_t) window;
+            batch.files[i].threshold = threshold;
+            batch.files[i].blockSize = (uint32_t) blockSize;
+            batch.files[i].schedule = (0 != points) ? schedule : NULL;
+            batch.files[i].points = points;
+            batch.files[i].format = format;
+        }
+
+        failed = RunBatch(&batch, (workers < 1) ? 1 : (uint32_t) workers);
+
+        fprintf(batch.report, "\nSOLA batch report:\n");
+        fprintf(batch.report, "  Files processed:         %u\n", batch.count);
+        fprintf(batch.report, "  Files failed:            %u\n", failed);
+        if (0 != silence) {
+            for (frames = silentFrames = 0, i = 0; i < batch.count; i++) {
+                frames += batch.files[i].frames;
+                silentFrames += batch.files[i].silentFrames;
+            }
+            fprintf(batch.report, "  Silent frames skipped:   %" PRIu64 " of %" PRIu64 "\n", silentFrames, frames);
+        }
+
+        if (NULL != statsFile) {
+            WriteStats(statsFile, &batch);
+        }
+
+        for (i = 0; i < batch.count; i++) {
+            free(batch.files[i].source);
+            free(batch.files[i].destination);
+        }
+        free(batch.files);
+        pthread_mutex_destroy(&batch.lock);
+
+        exit((0 == failed) ? 0 : 1);
+    }
+
+    /* 
+     * Perform Time-Scale Modification of speech.
+     */
+    if (0 != AddFile(&batch, argv[1], argv[2], alpha, frameSize)) {
+        Error("Not enough memory");
+    }
+    job = &batch.files[0];
+    job->segmentSize = (uint64_t) segmentSize;
+    job->threads = (uint32_t) workers;
+    job->stats = (NULL != statsFile);
+    job->silence = (uint16_t) silence;
+    job->decimation = (uint16_t) decimation;
+    job->candidates = (uint16_t) candidates;
+    job->window = (uint16_t) window;
+    job->threshold = threshold;
+    job->blockSize = (uint32_t) blockSize;
+    job->schedule = (0 != points) ? schedule : NULL;
+    job->points = points;
+    job->format = format;
+
+#ifdef VERBOSE
+    fprintf(batch.report, "PERFORMING Time-Scale Modification (TSM) ...\n");
+#endif
+    ProcessFile(job, batch.lagMode, 1);
+
+    /*
+     * The statistics are written even if the file failed.
+     */
+    if (NULL != statsFile) {
+        WriteStats(statsFile, &batch);
+    }
+
+    if (0 != job->err) {
+        Error("%s", job->message);
+    }
+
+    /*
+     * Display the report
+     */
+    fprintf(batch.report, "\nSOLA report:\n" );
+    fprintf(batch.report, "  Time-scale factor:       %0.2f\n", alpha);
+    fprintf(batch.report, "  Frame size:              %u%s\n", job->usedFrameSize, (AUTO_FRAMESIZE == job->frameSize) ? " (auto)" : "");
+    fprintf(batch.report, "  Channels:                %u\n", job->channels);
+    fprintf(batch.report, "  Number of bytes read:    %" PRIu64 "\n", job->bytesRead);
+    fprintf(batch.report, "  Number of bytes written: %" PRIu64 "\n", job->bytesWritten);
+    if (0 != silence) {
+        fprintf(batch.report, "  Silent frames skipped:   %" PRIu64 " of %" PRIu64 "\n", job->silentFrames, job->frames);
+    }
+
+    free(job->source);
+    free(job->destination);
+    free(batch.files);
 
     exit(0);
 }
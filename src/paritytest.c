@@ -0,0 +1,199 @@
+/*--------------------------------------------------------------------------
+    FILE                :   paritytest.c
+
+    PURPOSE             :   Test of the SOLA_FIXED_POINT build against the
+                            float build: both must select the same lags
+                            and give the same output. Built twice, once
+                            with solaapi.c compiled with SOLA_FIXED_POINT
+                            ("paritytest-fixed -w file" writes the lags
+                            and output), and once without ("paritytest
+                            file" compares its own with them).
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "typedef.h"
+#include "ulawapi.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define SIGNALS  5
+#define SIGNAL   16000U                         /* 2 seconds at 8 kHz */
+
+/*--------------------------------------------------------------------------
+    Local variables
+ --------------------------------------------------------------------------*/
+
+static const char *signalNames[SIGNALS] = { "tone", "noise", "clipped", "../audio/apu.au", "../audio/homer.au" };
+static const char *methodNames[] = { "auto", "direct", "FFT", "coarse", "pitch" };
+static uint32_t   seed = 1;
+
+/*--------------------------------------------------------------------------
+    Fail
+
+    Description:
+        Displays a failure and exits.
+ --------------------------------------------------------------------------*/
+
+void Fail(const char *what)
+{
+    fprintf(stderr, "paritytest: FAILED: %s\n", what);
+    exit(1);
+}
+
+/*--------------------------------------------------------------------------
+    Random
+
+    Description:
+        Returns a deterministic pseudo-random 16-bit sample (LCG).
+ --------------------------------------------------------------------------*/
+
+int16_t Random(void)
+{
+    seed = seed * 1664525U + 1013904223U;
+
+    return (int16_t) (seed >> 16);
+}
+
+/*--------------------------------------------------------------------------
+    Load
+
+    Description:
+        Generates a test signal (a tone, noise or an overdriven tone),
+        or reads one of the corpus files.
+ --------------------------------------------------------------------------*/
+
+void Load(int signal, int16_t *x[], uint32_t *xSize)
+{
+    FILE     *stream;
+    uint32_t sampleRate, i;
+    double   v;
+
+    if (signal >= 3) {
+        if ((NULL == (stream = fopen(signalNames[signal], "rb"))) ||
+            (0 != ULAW_ReadFile(1, stream, x, xSize, &sampleRate))) {
+            fprintf(stderr, "paritytest: %s\n", signalNames[signal]);
+            Fail("cannot read the corpus file");
+        }
+        fclose(stream);
+        return;
+    }
+
+    if (NULL == (*x = (int16_t *) malloc(SIGNAL * sizeof(int16_t)))) {
+        Fail("memory");
+    }
+    *xSize = SIGNAL;
+    for (i = 0; i < SIGNAL; i++) {
+        v = 8000.0 * sin(i * 0.0731) + 4000.0 * sin(i * 0.2113 + 1.0);
+        switch (signal) {
+        case 0:
+            (*x)[i] = (int16_t) v;
+            break;
+        case 1:
+            (*x)[i] = Random();
+            break;
+        default:
+            v *= 8.0;
+            (*x)[i] = (v <= -32768.0) ? -32768 : (v >= 32767.0) ? 32767 : (int16_t) v;
+            break;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    static const uint16_t frameSizes[] = { 160, 400 };
+    static const float    alphas[] = { 0.5f, 0.8f, 1.5f, 2.0f };
+    static const int      methods[] = { SOLA_SEARCH_DIRECT, SOLA_SEARCH_FFT, SOLA_SEARCH_COARSE, SOLA_SEARCH_PITCH };
+    sola_ctx_t *ctx;
+    FILE       *stream;
+    int16_t    *x, *y, *lags, *refLags, *ref;
+    uint64_t   count, ySize, header[2];
+    uint32_t   xSize, cases = 0;
+    size_t     n, a, m;
+    int        s, write;
+
+    write = (3 == argc) && (0 == strcmp(argv[1], "-w"));
+    if (!write && (2 != argc)) {
+        fprintf(stderr, "usage: paritytest [-w] file\n");
+        return 2;
+    }
+    if (NULL == (stream = fopen(argv[argc - 1], write ? "wb" : "rb"))) {
+        Fail("cannot open the lag file");
+    }
+
+    for (s = 0; s < SIGNALS; s++) {
+        Load(s, &x, &xSize);
+
+        for (n = 0; n < sizeof(frameSizes) / sizeof(frameSizes[0]); n++) {
+            for (a = 0; a < sizeof(alphas) / sizeof(alphas[0]); a++) {
+                for (m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+                    if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetFrameSize(ctx, frameSizes[n])) ||
+                        (0 != SOLA_CtxSetSearchMethod(ctx, methods[m]))) {
+                        Fail("context");
+                    }
+                    count = SOLA_CtxGetLagCount(ctx, xSize, alphas[a]);
+                    if ((NULL == (lags = (int16_t *) malloc((size_t) count * sizeof(int16_t)))) ||
+                        (0 != SOLA_CtxSetLagTrack(ctx, SOLA_LAGS_RECORD, lags, count)) ||
+                        (0 != SOLA_CtxProcess(ctx, x, xSize, &y, &ySize, alphas[a]))) {
+                        Fail("SOLA_CtxProcess");
+                    }
+                    SOLA_CtxDestroy(ctx);
+
+                    if (write) {
+                        header[0] = count;
+                        header[1] = ySize;
+                        if ((1 != fwrite(header, sizeof(header), 1, stream)) ||
+                            (count != fwrite(lags, sizeof(int16_t), (size_t) count, stream)) ||
+                            (ySize != fwrite(y, sizeof(int16_t), (size_t) ySize, stream))) {
+                            Fail("cannot write the lag file");
+                        }
+                    } else {
+                        if ((1 != fread(header, sizeof(header), 1, stream)) || (header[0] != count) ||
+                            (NULL == (refLags = (int16_t *) malloc((size_t) count * sizeof(int16_t)))) ||
+                            (NULL == (ref = (int16_t *) malloc(((size_t) header[1] + 1) * sizeof(int16_t)))) ||
+                            (count != fread(refLags, sizeof(int16_t), (size_t) count, stream)) ||
+                            (header[1] != fread(ref, sizeof(int16_t), (size_t) header[1], stream))) {
+                            Fail("lag file from another version of the test");
+                        }
+                        if ((0 != memcmp(lags, refLags, (size_t) count * sizeof(int16_t))) ||
+                            (header[1] != ySize) || (0 != memcmp(y, ref, (size_t) ySize * sizeof(int16_t)))) {
+                            fprintf(stderr, "paritytest: %s, %s search, framesize %u, alpha %g\n", signalNames[s],
+                                    methodNames[methods[m]], frameSizes[n], alphas[a]);
+                            Fail("the fixed-point build differs from the float build");
+                        }
+                        free(refLags);
+                        free(ref);
+                    }
+
+                    free(lags);
+                    free(y);
+                    cases++;
+                }
+            }
+        }
+        free(x);
+    }
+
+    fclose(stream);
+    if (!write) {
+        printf("paritytest: same lags and output in the float and fixed-point builds (%u cases): OK\n", cases);
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*--------------------------------------------------------------------------
+    FILE                :   rttest.c
+
+    PURPOSE             :   Test of the realtime API: no allocation after
+                            SOLA_CtxRealtimeBegin, output of each block
+                            within SOLA_CtxGetStreamBound, and the same
+                            output as SOLA_CtxProcess. Linked with
+                            -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+                            to count the allocations of the engine.
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "typedef.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define FRAMESIZE 400U
+#define SIGNAL    24000U                        /* 3 seconds at 8 kHz */
+
+/*--------------------------------------------------------------------------
+    Local variables
+ --------------------------------------------------------------------------*/
+
+static int      armed = 0;                      /* Count the allocations */
+static uint32_t allocations = 0;
+
+/*--------------------------------------------------------------------------
+    Allocation wrappers (see -Wl,--wrap)
+ --------------------------------------------------------------------------*/
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    if (armed) allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    if (armed) allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *p, size_t size)
+{
+    if (armed) allocations++;
+    return __real_realloc(p, size);
+}
+
+/*--------------------------------------------------------------------------
+    Fail
+
+    Description:
+        Displays a failure and exits.
+ --------------------------------------------------------------------------*/
+
+void Fail(const char *what, int method, float alpha, uint32_t blockSize)
+{
+    fprintf(stderr, "rttest: FAILED: %s (method %d, alpha %g, block %u)\n", what, method, alpha, blockSize);
+    exit(1);
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(void)
+{
+    static const int      methods[] = { SOLA_SEARCH_DIRECT, SOLA_SEARCH_FFT, SOLA_SEARCH_COARSE, SOLA_SEARCH_PITCH };
+    static const float    alphas[] = { 0.5f, 1.0f, 1.5f, 2.0f };
+    static const uint32_t blockSizes[] = { 1, 160, 4096 };
+    sola_ctx_t *ctx;
+    int16_t    x[SIGNAL], *y, *z;
+    uint64_t   ySize;
+    uint32_t   zSize, bound, block, i, n;
+    size_t     m, a, b;
+
+    for (i = 0; i < SIGNAL; i++) {
+        x[i] = (int16_t) ((8000.0 * sin(i * 0.0731) + 4000.0 * sin(i * 0.2113 + 1.0)) * (0.6 + 0.4 * sin(i * 0.0007)));
+    }
+
+    for (m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+        for (a = 0; a < sizeof(alphas) / sizeof(alphas[0]); a++) {
+            for (b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); b++) {
+                /*
+                 * Reference output.
+                 */
+                if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetFrameSize(ctx, FRAMESIZE)) ||
+                    (0 != SOLA_CtxSetSearchMethod(ctx, methods[m])) ||
+                    (0 != SOLA_CtxProcess(ctx, x, SIGNAL, &y, &ySize, alphas[a]))) {
+                    Fail("SOLA_CtxProcess", methods[m], alphas[a], blockSizes[b]);
+                }
+                SOLA_CtxDestroy(ctx);
+
+                /*
+                 * Realtime output, on a new context: everything must be
+                 * allocated by SOLA_CtxRealtimeBegin.
+                 */
+                if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetFrameSize(ctx, FRAMESIZE)) ||
+                    (0 != SOLA_CtxSetSearchMethod(ctx, methods[m])) ||
+                    (0 != SOLA_CtxRealtimeBegin(ctx, alphas[a], blockSizes[b]))) {
+                    Fail("SOLA_CtxRealtimeBegin", methods[m], alphas[a], blockSizes[b]);
+                }
+                bound = SOLA_CtxGetStreamBound(ctx, blockSizes[b]);
+                if (NULL == (z = (int16_t *) malloc(((size_t) ySize + bound) * sizeof(int16_t)))) {
+                    Fail("memory", methods[m], alphas[a], blockSizes[b]);
+                }
+
+                armed = 1;
+                for (i = 0, zSize = 0; i < SIGNAL; i += block) {
+                    block = ((SIGNAL - i) < blockSizes[b]) ? (SIGNAL - i) : blockSizes[b];
+                    if (0 != SOLA_CtxRealtimeProcess(ctx, &x[i], block, &z[zSize], &n)) {
+                        armed = 0;
+                        Fail("SOLA_CtxRealtimeProcess", methods[m], alphas[a], blockSizes[b]);
+                    }
+                    if (n > bound) {
+                        armed = 0;
+                        Fail("block output over SOLA_CtxGetStreamBound", methods[m], alphas[a], blockSizes[b]);
+                    }
+                    zSize += n;
+                }
+                if (0 != SOLA_CtxFlush(ctx, &z[zSize], &n)) {
+                    armed = 0;
+                    Fail("SOLA_CtxFlush", methods[m], alphas[a], blockSizes[b]);
+                }
+                zSize += n;
+                armed = 0;
+
+                if (0 != allocations) {
+                    Fail("memory allocated after SOLA_CtxRealtimeBegin", methods[m], alphas[a], blockSizes[b]);
+                }
+                if ((zSize != ySize) || (0 != memcmp(y, z, (size_t) ySize * sizeof(int16_t)))) {
+                    Fail("output differs from SOLA_CtxProcess", methods[m], alphas[a], blockSizes[b]);
+                }
+
+                free(y);
+                free(z);
+                SOLA_CtxDestroy(ctx);
+            }
+        }
+    }
+
+    printf("rttest: no allocation after SOLA_CtxRealtimeBegin: OK\n");
+
+    return 0;
+}
@@ -0,0 +1,278 @@
+/*--------------------------------------------------------------------------
+    FILE                :   searchbench.c
+
+    PURPOSE             :   Speed and accuracy of the coarse-to-fine and
+                            pitch-aware lag searches against the
+                            exhaustive search, for a range of settings
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "typedef.h"
+#include "ulawapi.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define RUNS    3                               /* Best of RUNS */
+#define SAMPLES 200                             /* Frames checked for the same lag */
+
+/*--------------------------------------------------------------------------
+    Local variables
+ --------------------------------------------------------------------------*/
+
+static const uint16_t decimations[] = { 2, 4, 8, 16 };
+static const uint16_t candidates[] = { 1, 2, 3, 4, 8 };
+static const uint16_t windows[] = { 4, 8, 16 };
+static const float    thresholds[] = { 0.5f, 0.7f, 0.8f };
+
+/*--------------------------------------------------------------------------
+    Now
+
+    Description:
+        Returns a monotonic time stamp in seconds.
+ --------------------------------------------------------------------------*/
+
+double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*--------------------------------------------------------------------------
+    SNR
+
+    Description:
+        Returns the signal-to-noise ratio (dB) of a test signal against
+        a reference signal, over the points they have in common.
+ --------------------------------------------------------------------------*/
+
+double SNR(int16_t ref[], uint64_t refSize, int16_t test[], uint64_t testSize)
+{
+    double   signal = 0.0, noise = 0.0, d;
+    uint64_t i, n = (refSize < testSize) ? refSize : testSize;
+
+    for (i = 0; i < n; i++) {
+        d = (double) ref[i] - test[i];
+        signal += (double) ref[i] * ref[i];
+        noise += d * d;
+    }
+
+    return (0.0 == noise) ? INFINITY : 10.0 * log10(signal / noise);
+}
+
+/*--------------------------------------------------------------------------
+    Run
+
+    Description:
+        Time-scales a signal RUNS times, recording its lags.
+
+    Return Value:
+        The elapsed time of the fastest run.
+ --------------------------------------------------------------------------*/
+
+double Run(sola_ctx_t *ctx, int16_t x[], uint32_t xSize, float alpha, int16_t lags[], uint64_t lagCount,
+           int16_t *y[], uint64_t *ySize)
+{
+    double t, best = 0.0;
+    int    run;
+
+    SOLA_CtxSetLagTrack(ctx, SOLA_LAGS_RECORD, lags, lagCount);
+
+    for (run = 0; run < RUNS; run++) {
+        if (run > 0) free(*y);
+        t = Now();
+        if (0 != SOLA_CtxProcess(ctx, x, xSize, y, ySize, alpha)) {
+            fprintf(stderr, "The file is smaller than the frame size\n");
+            exit(1);
+        }
+        t = Now() - t;
+        if ((0 == run) || (t < best)) best = t;
+    }
+
+    return best;
+}
+
+/*--------------------------------------------------------------------------
+    Agreement
+
+    Description:
+        Returns the percentage of frames for which the search of a
+        context finds the lag of the exhaustive search. Each frame m
+        is checked in the state of the exhaustive search: the exact
+        lags are applied to the frames before it, and the signal is
+        cut after it, so that its lag is the last one, given by the
+        size of the output.
+ --------------------------------------------------------------------------*/
+
+double Agreement(sola_ctx_t *ctx, int16_t x[], float alpha, int16_t exactLags[], uint64_t lagCount)
+{
+    uint16_t N = SOLA_CtxGetFrameSize(ctx);
+    uint16_t sa, ss;
+    uint64_t m, ySize, same = 0, checked = 0;
+    int16_t  *y;
+    int      s;
+
+    /*
+     * Interframe intervals, as SOLA computes them.
+     */
+    sa = (uint16_t) ((alpha > 1.0) ? (N / (2 * alpha)) : (N / 2));
+    ss = (uint16_t) (sa * alpha);
+
+    for (s = 0; s < SAMPLES; s++) {
+        m = ((uint64_t) (s + 1) * lagCount) / (SAMPLES + 1);
+        if (0 == m) {
+            continue;
+        }
+
+        SOLA_CtxSetLagTrack(ctx, SOLA_LAGS_APPLY, exactLags, m - 1);
+        if (0 != SOLA_CtxProcess(ctx, x, N + m * sa, &y, &ySize, alpha)) {
+            fprintf(stderr, "Not enough memory\n");
+            exit(1);
+        }
+        free(y);
+
+        same += ((int64_t) ySize - (int64_t) (m * ss) - N == exactLags[m - 1]);
+        checked++;
+    }
+
+    SOLA_CtxSetLagTrack(ctx, SOLA_LAGS_SEARCH, NULL, 0);
+
+    return (0 == checked) ? 100.0 : 100.0 * same / checked;
+}
+
+/*--------------------------------------------------------------------------
+    Report
+
+    Description:
+        Time-scales a signal with the search of a context, and prints
+        its results against the exhaustive search.
+ --------------------------------------------------------------------------*/
+
+void Report(const char *name, sola_ctx_t *ctx, int16_t x[], uint32_t xSize, float alpha, int16_t exact[],
+            uint64_t exactSize, double exactTime, int16_t exactLags[], int16_t lags[], uint64_t lagCount)
+{
+    sola_stats_t stats;
+    int16_t      *y;
+    uint64_t     ySize, same, i;
+    double       t, agreement;
+
+    memset(&stats, 0, sizeof(stats));
+    SOLA_CtxSetStats(ctx, &stats);
+    t = Run(ctx, x, xSize, alpha, lags, lagCount, &y, &ySize);
+    SOLA_CtxSetStats(ctx, NULL);
+
+    for (same = 0, i = 0; i < lagCount; i++) {
+        same += (lags[i] == exactLags[i]);
+    }
+
+    agreement = Agreement(ctx, x, alpha, exactLags, lagCount);
+
+    printf("%-10s %10.4f %8.2f %10lu %7.2f%% %9.2f%% %9.2f%% %10.2f\n", name, t, exactTime / t,
+           stats.lagEvaluations / RUNS, agreement, (0 == lagCount) ? 100.0 : 100.0 * same / lagCount,
+           (0 == stats.frames) ? 0.0 : 100.0 * stats.widenedSearches / stats.frames, SNR(exact, exactSize, y, ySize));
+    free(y);
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    FILE         *stream;
+    sola_ctx_t   *ctx;
+    sola_stats_t stats;
+    int16_t      *x, *exact;
+    int16_t      *exactLags, *lags;
+    uint32_t     xSize, sampleRate;
+    uint64_t     exactSize, lagCount;
+    uint64_t     exactEvaluations;
+    double       exactTime;
+    float        alpha;
+    char         name[16];
+    unsigned     d, c;
+
+    if ((argc < 3) || (argc > 4)) {
+        fprintf(stderr, "Usage: searchbench <source> <alpha> [<framesize>]\n");
+        return 1;
+    }
+
+    alpha = (float) atof(argv[2]);
+
+    if ((NULL == (stream = fopen(argv[1], "rb"))) || (0 != ULAW_ReadFile(1, stream, &x, &xSize, &sampleRate))) {
+        fprintf(stderr, "Problem reading %s\n", argv[1]);
+        return 1;
+    }
+    fclose(stream);
+
+    if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetFrameSize(ctx, (uint16_t) ((argc > 3) ? atoi(argv[3]) : 400)))) {
+        fprintf(stderr, "Invalid frame size\n");
+        return 1;
+    }
+
+    lagCount = SOLA_CtxGetLagCount(ctx, xSize, alpha);
+    exactLags = (int16_t *) malloc((size_t) (lagCount + 1) * sizeof(int16_t));
+    lags = (int16_t *) malloc((size_t) (lagCount + 1) * sizeof(int16_t));
+    if ((NULL == exactLags) || (NULL == lags)) {
+        fprintf(stderr, "Not enough memory\n");
+        return 1;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    SOLA_CtxSetStats(ctx, &stats);
+    exactTime = Run(ctx, x, xSize, alpha, exactLags, lagCount, &exact, &exactSize);
+    exactEvaluations = stats.lagEvaluations / RUNS;
+
+    printf("# %u samples, alpha %.2f, framesize %u, %" PRIu64 " frames\n", xSize, alpha, SOLA_CtxGetFrameSize(ctx), lagCount);
+    printf("# same_km: frames, in the state of the exhaustive search, for which the same lag is found\n");
+    printf("# same_track: frames with the same lag over a whole run (errors carry over)\n");
+    printf("# widened: frames of the pitch-aware search searched in full\n");
+    printf("%-10s %10s %8s %10s %8s %10s %10s %10s\n", "search", "seconds", "speedup", "evals", "same_km", "same_track",
+           "widened", "snr_db");
+    printf("%-10s %10.4f %8.2f %10lu %7.2f%% %9.2f%% %9.2f%% %10s\n", "exhaustive", exactTime, 1.0, exactEvaluations, 100.0,
+           100.0, 0.0, "inf");
+
+    SOLA_CtxSetSearchMethod(ctx, SOLA_SEARCH_COARSE);
+
+    for (d = 0; d < sizeof(decimations) / sizeof(decimations[0]); d++) {
+        for (c = 0; c < sizeof(candidates) / sizeof(candidates[0]); c++) {
+            SOLA_CtxSetCoarseSearch(ctx, decimations[d], candidates[c]);
+            snprintf(name, sizeof(name), "c%u,%u", decimations[d], candidates[c]);
+            Report(name, ctx, x, xSize, alpha, exact, exactSize, exactTime, exactLags, lags, lagCount);
+        }
+    }
+
+    SOLA_CtxSetSearchMethod(ctx, SOLA_SEARCH_PITCH);
+
+    for (d = 0; d < sizeof(windows) / sizeof(windows[0]); d++) {
+        for (c = 0; c < sizeof(thresholds) / sizeof(thresholds[0]); c++) {
+            SOLA_CtxSetPitchSearch(ctx, windows[d], thresholds[c]);
+            snprintf(name, sizeof(name), "p%u,%.1f", windows[d], thresholds[c]);
+            Report(name, ctx, x, xSize, alpha, exact, exactSize, exactTime, exactLags, lags, lagCount);
+        }
+    }
+
+    free(exact);
+    free(exactLags);
+    free(lags);
+    free(x);
+    SOLA_CtxDestroy(ctx);
+
+    return 0;
+}
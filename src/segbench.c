@@ -0,0 +1,135 @@
+/*--------------------------------------------------------------------------
+    FILE                :   segbench.c
+
+    PURPOSE             :   Speed and quality of the segmented SOLA
+                            processing against the serial processing,
+                            for a range of segment sizes
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "typedef.h"
+#include "ulawapi.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define MIN_SEGMENT (1U << 17)                  /* Smallest segment size tried */
+#define MAX_SEGMENT (1U << 22)                  /* Largest segment size tried */
+
+/*--------------------------------------------------------------------------
+    Now
+
+    Description:
+        Returns a monotonic time stamp in seconds.
+ --------------------------------------------------------------------------*/
+
+double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*--------------------------------------------------------------------------
+    SNR
+
+    Description:
+        Returns the signal-to-noise ratio (dB) of a test signal against
+        a reference signal, over the points they have in common.
+ --------------------------------------------------------------------------*/
+
+double SNR(int16_t ref[], uint64_t refSize, int16_t test[], uint64_t testSize)
+{
+    double   signal = 0.0, noise = 0.0, d;
+    uint64_t i, n = (refSize < testSize) ? refSize : testSize;
+
+    for (i = 0; i < n; i++) {
+        d = (double) ref[i] - test[i];
+        signal += (double) ref[i] * ref[i];
+        noise += d * d;
+    }
+
+    return (0.0 == noise) ? INFINITY : 10.0 * log10(signal / noise);
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    FILE       *stream;
+    sola_ctx_t *ctx;
+    int16_t    *x, *serial, *y;
+    uint32_t   xSize, sampleRate, threads;
+    uint64_t   serialSize, ySize, segmentSize;
+    double     t, serialTime;
+    float      alpha;
+
+    if ((argc < 3) || (argc > 5)) {
+        fprintf(stderr, "Usage: segbench <source> <alpha> [<framesize> [<threads>]]\n");
+        return 1;
+    }
+
+    alpha = (float) atof(argv[2]);
+    threads = (argc > 4) ? (uint32_t) atoi(argv[4]) : (uint32_t) sysconf(_SC_NPROCESSORS_ONLN);
+
+    if ((NULL == (stream = fopen(argv[1], "rb"))) || (0 != ULAW_ReadFile(1, stream, &x, &xSize, &sampleRate))) {
+        fprintf(stderr, "Problem reading %s\n", argv[1]);
+        return 1;
+    }
+    fclose(stream);
+
+    if ((0 != SOLA_CtxCreate(&ctx)) || ((argc > 3) && (0 != SOLA_CtxSetFrameSize(ctx, (uint16_t) atoi(argv[3]))))) {
+        fprintf(stderr, "Invalid frame size\n");
+        return 1;
+    }
+
+    t = Now();
+    if (0 != SOLA_CtxProcess(ctx, x, xSize, &serial, &serialSize, alpha)) {
+        fprintf(stderr, "The file is smaller than the frame size\n");
+        return 1;
+    }
+    serialTime = Now() - t;
+
+    printf("# %u samples, alpha %.2f, framesize %u, %u threads\n", xSize, alpha, SOLA_CtxGetFrameSize(ctx), threads);
+    printf("%-10s %10s %8s %10s %12s\n", "segment", "seconds", "speedup", "snr_db", "size_delta");
+    printf("%-10s %10.4f %8.2f %10s %12d\n", "serial", serialTime, 1.0, "inf", 0);
+
+    for (segmentSize = MIN_SEGMENT; segmentSize <= MAX_SEGMENT; segmentSize <<= 1) {
+        t = Now();
+        if (0 != SOLA_CtxProcessSegmented(ctx, x, xSize, &y, &ySize, alpha, segmentSize, threads)) {
+            fprintf(stderr, "Segmented processing failed\n");
+            return 1;
+        }
+        t = Now() - t;
+
+        printf("%-10lu %10.4f %8.2f %10.2f %12ld\n", segmentSize, t, serialTime / t,
+               SNR(serial, serialSize, y, ySize), (long) ySize - (long) serialSize);
+        free(y);
+
+        if (segmentSize >= xSize) {
+            break;
+        }
+    }
+
+    free(serial);
+    free(x);
+    SOLA_CtxDestroy(ctx);
+
+    return 0;
+}
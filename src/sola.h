@@ -0,0 +1,41 @@
+/*--------------------------------------------------------------------------
+    FILE                :   sola.h
+
+    PURPOSE             :   Public interface of the SOLA library (libsola):
+                            the TSM engine, the audio file codecs and
+                            the DSP kernels
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+/*
+ * Installed with the headers it includes (see "make install"), e.g. as
+ * <sola/sola.h>, and linked with -lsola -lm -lpthread.
+ *
+ * Thread safety: a SOLA context (sola_ctx_t) belongs to one thread at a
+ * time, and any number of contexts may be used at the same time. The
+ * file functions of the ulaw API may be called from any thread, on
+ * different streams; their statistics are per thread (see
+ * ULAW_SetStats). The settings of SOLA_TSM are shared by the process
+ * and may be changed at any time. The dot product kernel is shared as
+ * well, and must only be selected before other threads use the library
+ * (see DSP_SelectKernel).
+ *
+ * Versioning: SOLA_VERSION is the version of the headers, and
+ * SOLA_GetVersion the one of the library. Functions are only added
+ * within a major version, so a program runs with any library of the
+ * same major version and the same or a later minor version.
+ */
+
+#ifndef __SOLA_H                                /* Prevent multiple includes */
+#define __SOLA_H
+
+#include "typedef.h"
+#include "dspapi.h"
+#include "ulawapi.h"
+#include "solaapi.h"
+
+#endif /* __SOLA_H */
@@ -12,21 +12,210 @@
 
 #include <errno.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 #include "typedef.h"
+#include "dspapi.h"
 #include "solaapi.h"
 
 /*--------------------------------------------------------------------------
     ===> PRIVATE <===
  --------------------------------------------------------------------------*/
 
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+/*
+ * Smallest frame size for which SOLA_SEARCH_AUTO selects the FFT-based
+ * lag search. Below it, the brute-force search is cheaper. The vector
+ * dot product kernels move the break-even point much higher.
+ */
+#define SOLA_FFT_THRESHOLD      768U
+#define SOLA_FFT_THRESHOLD_SIMD 4096U
+
+#define SOLA_DEFAULT_FRAMESIZE 160U
+
+/*
+ * Size of the input and output buffers of a stream, in frames. A stream
+ * needs at most one frame of input and two frames of output.
+ */
+#define SOLA_STREAM_FRAMES     4U
+
+/*
+ * Segmented processing (see SOLA_CtxProcessSegmented). Each segment
+ * runs about SOLA_SEAM_MARGIN * N output samples past the start of the
+ * next one, which is where the seam is searched for. A segment is at
+ * least SOLA_SEGMENT_MIN * N input samples long.
+ */
+#define SOLA_SEAM_MARGIN       256U
+#define SOLA_SEGMENT_MIN       1024U
+
+/*
+ * Coarse-to-fine lag search (see SOLA_SearchCoarse). The defaults keep
+ * the 3 best of every 4th lag. Frames with fewer than SOLA_COARSE_MIN
+ * coarse lags are searched exhaustively.
+ */
+#define SOLA_DEFAULT_DECIMATION 4U
+#define SOLA_DEFAULT_CANDIDATES 3U
+#define SOLA_COARSE_MIN         4
+
+/*
+ * Pitch-aware lag search (see SOLA_SearchPitch). The defaults try the
+ * lags within 8 points of the predicted one, and accept the best if its
+ * normalized cross-correlation is at least 0.7.
+ */
+#define SOLA_DEFAULT_WINDOW     8U
+#define SOLA_DEFAULT_THRESHOLD  0.7f
+
+/*
+ * Silence gate (see SOLA_CtxSetSilenceThreshold). Off by default, so
+ * that the output is the same as without it.
+ */
+#define SOLA_DEFAULT_SILENCE    0U
+
+/*--------------------------------------------------------------------------
+    General constants and data types
+ --------------------------------------------------------------------------*/
+
+/*
+ * With SOLA_FIXED_POINT defined, the lag search uses integers only: the
+ * energies are accumulated in 64 bits and the normalized
+ * cross-correlations num / sqrt(ex * ey) are compared exactly, without
+ * the square root, by cross-multiplying their squares in multiprecision
+ * (see SOLA_Higher). The FFT-based search, which works in floating
+ * point, is then never used. The overlap-add is the same in both
+ * builds (see SOLA_OverlapFrame), so that they give the same output.
+ */
+#ifdef SOLA_FIXED_POINT
+#define SOLA_LIMBS 4                            /* 32-bit limbs of ex * ey */
+
+struct sola_corr {
+    int64_t  num;                               /* Numerator */
+    uint32_t denom[SOLA_LIMBS];                 /* Square of the denominator */
+};
+
+typedef int64_t          sola_energy_t;
+typedef struct sola_corr sola_corr_t;
+#else
+typedef double           sola_energy_t;
+typedef float            sola_corr_t;
+#endif
+
+struct sola_ctx {
+    uint16_t  N;                                /* Size of the overlapping frames */
+    int       searchMethod;                     /* Lag search method */
+    uint64_t  lastSampleIndex;
+    dsp_fft_t *fft;                             /* FFT plan (FFT-based search) */
+    double    *xcorr;                           /* Cross-correlation of a frame */
+    sola_energy_t *Ex, *Ey;                     /* Energy tables of a frame */
+
+    /*
+     * Coarse-to-fine search (see SOLA_CtxSetCoarseSearch).
+     */
+    uint16_t  decimation;                       /* Coarse lag step */
+    uint16_t  candidates;                       /* Coarse lags refined */
+    int16_t   *xd, *yd;                         /* Decimated frame */
+    sola_energy_t *Exd, *Eyd;                   /* Energy tables of xd & yd */
+
+    /*
+     * Pitch-aware search (see SOLA_CtxSetPitchSearch).
+     */
+    uint16_t  window;                           /* Half width of the narrow search */
+    float     threshold;                        /* Lowest correlation accepted */
+    sola_corr_t Rt;                             /* threshold, as a correlation */
+    int16_t   pitchLag;                         /* Predicted lag of the next frame */
+    int       pitchValid;                       /* pitchLag is set */
+    uint16_t  pitchJump;                        /* Last shift of a widened search */
+
+    /*
+     * Silence gate (see SOLA_CtxSetSilenceThreshold).
+     */
+    uint16_t  silence;                          /* RMS level of silence (0 = off) */
+    sola_energy_t silenceEnergy;                /* silence^2, the energy of a silent point */
+    uint64_t  frames;                           /* Frames synthesized (see SOLA_CtxGetFrameCounts) */
+    uint64_t  silentFrames;                     /* Frames not searched (silent) */
+
+    /*
+     * Streaming state (see SOLA_CtxBegin). The buffers hold the input
+     * samples from xBase and the output samples from yBase, which are
+     * indexes in the whole input and output signals.
+     */
+    uint16_t  sa, ss;                           /* Interframe intervals */
+    uint64_t  frame;                            /* Next frame (m), 0 before the first */
+    uint64_t  xPos, yPos;                       /* mSa & mSs of the next frame */
+    uint64_t  xBase, yBase;                     /* Indexes of xBuf[0] & yBuf[0] */
+    uint32_t  xCount;                           /* Samples in the input buffer */
+    uint64_t  yEmitted;                         /* Next output sample to emit */
+    uint32_t  capacity;                         /* Size of the buffers */
+    int16_t   *xBuf, *yBuf;
+    uint32_t  blockSize;                        /* Realtime block (0 = not realtime) */
+
+    /*
+     * Lag track (see SOLA_CtxSetLagTrack).
+     */
+    int       lagMode;                          /* SOLA_LAGS_xxx */
+    int16_t   *lags;                            /* Lag of frame m at lags[m - 1] */
+    uint64_t  lagCount;                         /* Number of entries in lags */
+
+    /*
+     * Alpha schedule (see SOLA_CtxSetSchedule & SOLA_CtxSetAlphaCallback).
+     */
+    sola_alpha_fn_t alphaFn;                    /* Alpha of a frame (NULL = constant) */
+    void      *alphaArg;
+    float     alphaMin, alphaMax;               /* Range of alphaFn */
+    const sola_breakpoint_t *points;            /* Breakpoints (caller's) */
+    uint32_t  pointCount;
+    uint32_t  point;                            /* Breakpoint of the last position */
+
+    sola_stats_t *stats;                        /* Statistics (NULL = not collected) */
+};
+
+struct sola_segment {
+    int16_t  *x;                                /* First input sample of the segment */
+    uint64_t xSize;                             /* Input samples, margin included */
+    int16_t  *y;                                /* Synthetic signal of the segment */
+    uint64_t ySize;
+    int64_t  offset;                            /* Index of y[0] in the whole output */
+    uint64_t cross;                             /* Seam with the previous segment */
+    uint16_t fade;                              /* Crossfade of the seam (points) */
+};
+
+typedef struct sola_segment sola_segment_t;
+
+struct sola_segment_job {
+    sola_ctx_t      *ctx;                       /* Settings of the segments */
+    sola_segment_t  *segments;
+    uint32_t        count;                      /* Number of segments */
+    uint32_t        next;                       /* Next segment to process */
+    float           alpha;
+    int             err;                        /* First error of a worker */
+    sola_stats_t    stats;                      /* Statistics of the workers */
+    pthread_mutex_t lock;                       /* Protects next, err & stats */
+};
+
+typedef struct sola_segment_job sola_segment_job_t;
+
 /*--------------------------------------------------------------------------
     Local variables
  --------------------------------------------------------------------------*/
 
-static uint16_t N = 160;                        /* Size of the overlapping frames */
-static uint32_t lastSampleIndex;
+/*
+ * Settings used by SOLA_TSM (see SOLA_SetFrameSize & SOLA_SetSearchMethod),
+ * shared by all the threads of the process.
+ */
+static pthread_mutex_t defaultLock = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t defaultFrameSize = SOLA_DEFAULT_FRAMESIZE;
+static int      defaultSearchMethod = SOLA_SEARCH_AUTO;
+static uint16_t defaultDecimation = SOLA_DEFAULT_DECIMATION;
+static uint16_t defaultCandidates = SOLA_DEFAULT_CANDIDATES;
+static uint16_t defaultWindow = SOLA_DEFAULT_WINDOW;
+static float    defaultThreshold = SOLA_DEFAULT_THRESHOLD;
+static uint16_t defaultSilence = SOLA_DEFAULT_SILENCE;
+static sola_stats_t *defaultStats = NULL;
 
 /*--------------------------------------------------------------------------
     SOLA_GetIntervals
@@ -37,224 +226,2472 @@ static uint32_t lastSampleIndex;
         on alpha and N.
 
     Parameters:
+        ctx - SOLA context
         alpha - Time-scale factor
         sa - Analysis interframe interval (pointer)
         ss - Synthesis interframe interval (pointer)
  --------------------------------------------------------------------------*/
 
-static void SOLA_GetIntervals(float alpha, uint16_t *sa, uint16_t *ss)
+static void SOLA_GetIntervals(sola_ctx_t *ctx, float alpha, uint16_t *sa, uint16_t *ss)
 {
+    uint16_t N = ctx->N;
+
     *sa = (uint16_t) ((alpha > 1.0) ? (N / (2 * alpha)) : (N / 2));
     *ss = (uint16_t) (*sa * alpha);
 }
 
 /*--------------------------------------------------------------------------
-    SOLA_CrossCorrelation:
+    SOLA_GetFrameIntervals
 
     Description:
-        Computes the normalized cross-correlation between two signals.
+        Calculates the interframe intervals from a frame to the next
+        one, with the alpha of the schedule at the frame.
 
     Parameters:
-        x and y - Input and output signals
-        points - Number of points used to compute
+        ctx - SOLA context (with a schedule)
+        position - Index of the frame in the input signal (mSa)
+        sa - Analysis interframe interval (pointer)
+        ss - Synthesis interframe interval (pointer)
  --------------------------------------------------------------------------*/
 
-static float SOLA_CrossCorrelation(int16_t x[], int16_t y[], uint16_t points)
+static void SOLA_GetFrameIntervals(sola_ctx_t *ctx, uint64_t position, uint16_t *sa, uint16_t *ss)
 {
-    double   sum[3] = {0.0, 0.0, 0.0};
-    double   denom;
-    uint16_t j;
-
-    for (j = 0; j < points; j++) {
-        sum[0] += x[j] * y[j];                  /* Numerator */
-        sum[1] += x[j] * x[j];                  /* Denominator */
-        sum[2] += y[j] * y[j];
-    }
+    float alpha = ctx->alphaFn(ctx->alphaArg, position);
 
-    if (0.0 == (denom = sqrt(sum[1] * sum[2]))) {
-        return 0.0;
-    }
+    if (!(alpha >= ctx->alphaMin)) alpha = ctx->alphaMin;
+    if (alpha > ctx->alphaMax) alpha = ctx->alphaMax;
 
-    return (float) (sum[0] / denom);
+    SOLA_GetIntervals(ctx, alpha, sa, ss);
+    if (0 == *sa) *sa = 1;
 }
 
 /*--------------------------------------------------------------------------
-    SOLA_FindLag:
+    SOLA_ScheduleAlpha
 
     Description:
-        Find the highest cross-correlation point.
+        Alpha callback of a breakpoint schedule (see
+        SOLA_CtxSetSchedule). The positions of the frames increase, so
+        the breakpoints are scanned from the last one used.
 
     Parameters:
-        x and y - Input and output signals
-        sa - Analysis interframe interval
-        ss - Synthesis interframe interval
-        m - Size of the overlapping frames
+        arg - SOLA context
+        position - Index of the frame in the input signal
  --------------------------------------------------------------------------*/
 
-static int16_t SOLA_FindLag(int16_t x[], int16_t y[], uint16_t sa, uint16_t ss, uint16_t m)
+static float SOLA_ScheduleAlpha(void *arg, uint64_t position)
 {
-    int16_t  k, km = 0;
-    uint16_t L;
-    float    R, Rm = -1;
+    sola_ctx_t              *ctx = (sola_ctx_t *) arg;
+    const sola_breakpoint_t *p = ctx->points;
+    uint32_t                i = ctx->point;
+    double                  t;
 
-    k = -(((m * ss) >= (N / 2)) ? (N / 2) : ss);
+    if (position < p[i].position) {
+        i = 0;                                  /* A new signal */
+    }
+    while (((i + 1) < ctx->pointCount) && (p[i + 1].position <= position)) {
+        i++;
+    }
+    ctx->point = i;
 
     /*
-     * Number of points of overlap between y(mSs+k+j) and x(mSa+j).
+     * Constant before the first breakpoint and after the last one.
      */
-    L = N;
-    if ((uint32_t) (((m * ss) + k) + N) > lastSampleIndex) {
-        L = (uint16_t) (lastSampleIndex - ((m * ss) + k));
+    if ((position < p[i].position) || ((i + 1) == ctx->pointCount)) {
+        return p[i].alpha;
     }
 
-    for ( ; k <= (N / 2); k++, L--) {
-        /*
-         * The cross-correlation function as defined will indicate a high
-         * correlation between y and x when L is small, which could lead
-         * to errant synchronization. To remedy this situation, we restricted
-         * L to taking on values greater than N / 8.
-         */
-        if (L < (N / 8))
-            break;
+    t = (double) (position - p[i].position) / (double) (p[i + 1].position - p[i].position);
 
-        /*
-         * Obtain the aligment by computing the normalized cross-correlation
-         * between x(mSa+j) and y(mSs+k+j).
-         */
-        if ((R = SOLA_CrossCorrelation(&x[m * sa], &y[m * ss + k], L)) > Rm) {
-            Rm = R;
-            km = k;
+    return (float) (p[i].alpha + t * (p[i + 1].alpha - p[i].alpha));
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CountFrames
+
+    Description:
+        Returns the number of frames synthesized from an input signal
+        of xSize samples with the schedule of a context.
+
+    Parameters:
+        ctx - SOLA context (with a schedule)
+        xSize - Number of input samples
+        lastPos - Index of the last frame in the output signal
+                  (pointer, may be NULL)
+ --------------------------------------------------------------------------*/
+
+static uint64_t SOLA_CountFrames(sola_ctx_t *ctx, uint64_t xSize, uint64_t *lastPos)
+{
+    uint16_t sa, ss;
+    uint64_t xPos = 0, yPos = 0, m = 0;
+
+    for (;;) {
+        SOLA_GetFrameIntervals(ctx, xPos, &sa, &ss);
+        if ((xPos + sa + ctx->N) > xSize) {
+            break;
         }
+        xPos += sa;
+        yPos += ss;
+        m++;
     }
 
-    return km;
+    if (NULL != lastPos) *lastPos = yPos;
+
+    return m;
 }
 
 /*--------------------------------------------------------------------------
-    SOLA_OverlapFrame
+    SOLA_Clock
 
     Description:
-        Weights and averages x(mSa+j) with y(mSs+km+j) along their
-        points of overlap.
+        Reads the monotonic clock and the CPU time of the calling
+        thread (ns).
+ --------------------------------------------------------------------------*/
+
+static void SOLA_Clock(uint64_t *wall, uint64_t *cpu)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *wall = (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    *cpu = (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_AddTime
+
+    Description:
+        Adds the time elapsed since a reading of SOLA_Clock to the
+        statistics of a context, if they are collected.
+ --------------------------------------------------------------------------*/
+
+static void SOLA_AddTime(sola_ctx_t *ctx, uint64_t wall, uint64_t cpu)
+{
+    uint64_t now, nowCpu;
+
+    if (NULL == ctx->stats) {
+        return;
+    }
+
+    SOLA_Clock(&now, &nowCpu);
+    ctx->stats->wallTime += now - wall;
+    ctx->stats->cpuTime += nowCpu - cpu;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_Energies:
+
+    Description:
+        Fills the energy tables of a frame. Ex[L] is the energy of the
+        first L points of x, and Ey[d] is the energy of the points of
+        y from d up to the end of the frame.
 
     Parameters:
+        Ex and Ey - Energy tables (points + 1 entries)
         x and y - Input and output signals
-        sa - Analysis interframe interval
-        ss - Synthesis interframe interval
-        m - Size of the overlapping frames
-        km - Denote the lag at which Rm(k) is maximum
+        points - Number of points of the frame
  --------------------------------------------------------------------------*/
 
-static void SOLA_OverlapFrame(int16_t x[], int16_t y[], uint16_t sa, uint16_t ss, uint16_t m, int16_t km)
+static void SOLA_Energies(sola_energy_t Ex[], sola_energy_t Ey[], int16_t x[], int16_t y[], uint16_t points)
 {
-    uint16_t Lm;                                /* Range of overlap */
     uint16_t j;
 
-    Lm = N;
-    if ((uint32_t) (((m * ss) + km) + N) > lastSampleIndex) {
-        Lm = (uint16_t) (lastSampleIndex - ((m * ss) + km));
+    Ex[0] = 0;
+    for (j = 0; j < points; j++) {
+        Ex[j + 1] = Ex[j] + x[j] * x[j];
     }
 
-    for (j = 0; j < Lm; j++) {
-        y[m * ss + km + j] = (int16_t) ((1 - j / Lm) * y[m * ss + km + j] + (j / Lm) * x[m * sa + j]);
+    Ey[points] = 0;
+    for (j = points; j > 0; j--) {
+        Ey[j - 1] = Ey[j] + y[j - 1] * y[j - 1];
     }
+}
 
-    if (Lm < N) {
-        memcpy(&y[m * ss + km + Lm], &x[m * sa + Lm], (N - Lm) * sizeof(int16_t));
+#ifdef SOLA_FIXED_POINT
+/*--------------------------------------------------------------------------
+    SOLA_MulLimbs
+
+    Description:
+        Multiplies two unsigned multiprecision numbers of 32-bit limbs
+        (least significant first). r has na + nb limbs.
+ --------------------------------------------------------------------------*/
+
+static void SOLA_MulLimbs(const uint32_t a[], int na, const uint32_t b[], int nb, uint32_t r[])
+{
+    uint64_t carry;
+    int      i, j;
+
+    memset(r, 0, (na + nb) * sizeof(uint32_t));
+
+    for (i = 0; i < na; i++) {
+        for (carry = 0, j = 0; j < nb; j++) {
+            carry += (uint64_t) a[i] * b[j] + r[i + j];
+            r[i + j] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        r[i + nb] = (uint32_t) carry;
     }
 }
 
 /*--------------------------------------------------------------------------
-    ===> PUBLIC <===
+    SOLA_SquareMagnitude
+
+    Description:
+        Squares the magnitude of a numerator into 4 limbs.
  --------------------------------------------------------------------------*/
 
+static void SOLA_SquareMagnitude(int64_t num, uint32_t square[4])
+{
+    uint64_t m = (num < 0) ? -(uint64_t) num : (uint64_t) num;
+    uint32_t n[2];
+
+    n[0] = (uint32_t) m;
+    n[1] = (uint32_t) (m >> 32);
+    SOLA_MulLimbs(n, 2, n, 2, square);
+}
+
 /*--------------------------------------------------------------------------
-    SOLA_SetFrameSize
+    SOLA_CmpLimbs
 
     Description:
-        Call this function to set the size of the overlapping frames.
-        The size must be greater than 1 (default = 160 ).
+        Compares two multiprecision numbers of n limbs.
 
     Return Value:
-        Nonzero if the size of the frames was set; otherwise 0.
+        Negative, zero or positive as a is lower than, equal to or
+        greater than b.
  --------------------------------------------------------------------------*/
 
-int SOLA_SetFrameSize(uint16_t frameSize)
+static int SOLA_CmpLimbs(const uint32_t a[], const uint32_t b[], int n)
 {
-    if (0 == frameSize) {
-        return EINVAL;
+    while (n-- > 0) {
+        if (a[n] != b[n]) {
+            return (a[n] > b[n]) ? 1 : -1;
+        }
     }
 
-    N = frameSize;
-
     return 0;
 }
+#endif
 
 /*--------------------------------------------------------------------------
-    SOLA_GetFrameSize
+    SOLA_CrossCorrelation:
 
     Description:
-        Returns the size of the overlapping frames.
+        Computes the normalized cross-correlation between two signals
+        from its numerator and the energies of both signals. In fixed
+        point, the numerator and the square of the denominator are
+        kept apart.
+
+    Parameters:
+        num - Numerator (dot product of x and y)
+        ex and ey - Energies of x and y
  --------------------------------------------------------------------------*/
 
-uint16_t SOLA_GetFrameSize(void)
+static sola_corr_t SOLA_CrossCorrelation(int64_t num, sola_energy_t ex, sola_energy_t ey)
 {
-    return N;
+#ifdef SOLA_FIXED_POINT
+    sola_corr_t R;
+    uint32_t    a[2], b[2];
+
+    /*
+     * A zero denominator gives a zero cross-correlation.
+     */
+    if ((0 == ex) || (0 == ey)) {
+        ex = ey = 1;
+        num = 0;
+    }
+
+    a[0] = (uint32_t) ex;
+    a[1] = (uint32_t) ((uint64_t) ex >> 32);
+    b[0] = (uint32_t) ey;
+    b[1] = (uint32_t) ((uint64_t) ey >> 32);
+    SOLA_MulLimbs(a, 2, b, 2, R.denom);
+    R.num = num;
+
+    return R;
+#else
+    double denom;
+
+    if (0.0 == (denom = sqrt(ex * ey))) {
+        return 0.0;
+    }
+
+    return (float) ((double) num / denom);
+#endif
 }
 
 /*--------------------------------------------------------------------------
-    SOLA_TSM
+    SOLA_Higher
 
     Description:
-        Time-Scale Modification of speech using SOLA.
+        Tells if a normalized cross-correlation is higher than another.
+        In fixed point, with numerators of the same sign,
+        a / sqrt(da) > b / sqrt(db) if and only if a^2 * db > b^2 * da
+        for positive numerators, and the reverse for negative ones.
+        The energies and the numerators are below 2^47, so the
+        products fit in 8 limbs.
  --------------------------------------------------------------------------*/
 
-int SOLA_TSM(int16_t x[], uint32_t xSize, int16_t *y[], uint32_t *ySize, float alpha)
+static int SOLA_Higher(const sola_corr_t *a, const sola_corr_t *b)
 {
-    uint16_t sa, ss;                            /* Interframe intervals */
-    uint16_t m, maxFrames;
-    int16_t  km;
+#ifdef SOLA_FIXED_POINT
+    int      sa = (a->num > 0) - (a->num < 0);
+    int      sb = (b->num > 0) - (b->num < 0);
+    uint32_t square[4], left[2 * SOLA_LIMBS], right[2 * SOLA_LIMBS];
+    int      cmp;
+
+    if ((sa != sb) || (0 == sa)) {
+        return sa > sb;
+    }
+
+    SOLA_SquareMagnitude(a->num, square);
+    SOLA_MulLimbs(square, 4, b->denom, SOLA_LIMBS, left);
+
+    SOLA_SquareMagnitude(b->num, square);
+    SOLA_MulLimbs(square, 4, a->denom, SOLA_LIMBS, right);
+
+    cmp = SOLA_CmpLimbs(left, right, 2 * SOLA_LIMBS);
+
+    return (sa > 0) ? (cmp > 0) : (cmp < 0);
+#else
+    return *a > *b;
+#endif
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SearchCoarse
+
+    Description:
+        Coarse-to-fine search of the lag of a frame. Both signals are
+        low-passed (mean of D points) and decimated by D, and every
+        lag of the decimated signals, i.e. every Dth lag, is tried.
+        The lags within D - 1 of the best few coarse lags are then
+        tried at full rate. The result is usually, but not always, the
+        lag of the exhaustive search.
+
+    Parameters:
+        ctx - SOLA context (energy tables of the frame filled)
+        x - Input signal, from x(mSa)
+        ym - Output signal, from the first lag
+        L - Number of points of overlap of the first lag
+        lags - Number of lags
+
+    Return Value:
+        Index of the best lag, from the first one.
+ --------------------------------------------------------------------------*/
+
+static uint16_t SOLA_SearchCoarse(sola_ctx_t *ctx, int16_t x[], int16_t ym[], uint16_t L, uint16_t lags)
+{
+    uint16_t    D = ctx->decimation;
+    uint16_t    Ld = L / D;                     /* Points of the decimated frame */
+    uint16_t    coarseLags = (uint16_t) ((lags - 1) / D + 1);
+    uint16_t    best[SOLA_MAX_CANDIDATES];      /* Best coarse lags */
+    sola_corr_t bestR[SOLA_MAX_CANDIDATES];
+    sola_corr_t R, Rm = SOLA_CrossCorrelation(-1, 1, 1);
+    uint16_t    n = 0, c, i, j, dm = 0;
+    uint32_t    d, first, last, next = 0;
+    uint64_t    evaluations;
+    int32_t     sx, sy;
+
+    for (i = 0; i < Ld; i++) {
+        for (sx = sy = 0, j = 0; j < D; j++) {
+            sx += x[i * D + j];
+            sy += ym[i * D + j];
+        }
+        ctx->xd[i] = (int16_t) (sx / D);
+        ctx->yd[i] = (int16_t) (sy / D);
+    }
+    SOLA_Energies(ctx->Exd, ctx->Eyd, ctx->xd, ctx->yd, Ld);
+
+    if (coarseLags > Ld) {
+        coarseLags = Ld;
+    }
 
     /*
-     * The size of the original signal must be greater than N.
+     * Keep the best coarse lags, sorted from the highest correlation.
      */
-    if (xSize < N) {
-        return EINVAL;
+    for (d = 0; d < coarseLags; d++) {
+        R = SOLA_CrossCorrelation(DSP_DotProduct(ctx->xd, &ctx->yd[d], Ld - d), ctx->Exd[Ld - d], ctx->Eyd[d]);
+        for (i = n; (i > 0) && SOLA_Higher(&R, &bestR[i - 1]); i--) {
+            if (i < ctx->candidates) {
+                best[i] = best[i - 1];
+                bestR[i] = bestR[i - 1];
+            }
+        }
+        if (i < ctx->candidates) {
+            best[i] = (uint16_t) d;
+            bestR[i] = R;
+            if (n < ctx->candidates) n++;
+        }
+    }
+
+    /*
+     * Refine them in increasing order of lag, so that ties go to the
+     * first lag as in the exhaustive search.
+     */
+    for (i = 1; i < n; i++) {
+        for (j = i; (j > 0) && (best[j] < best[j - 1]); j--) {
+            c = best[j];
+            best[j] = best[j - 1];
+            best[j - 1] = c;
+        }
+    }
+
+    evaluations = coarseLags;
+    for (c = 0; c < n; c++) {
+        first = ((uint32_t) best[c] * D >= D) ? ((uint32_t) best[c] * D - D + 1) : 0;
+        last = (uint32_t) best[c] * D + D - 1;
+        if (first < next) first = next;
+        if (last > (uint32_t) (lags - 1)) last = lags - 1;
+
+        for (d = first; d <= last; d++) {
+            R = SOLA_CrossCorrelation(DSP_DotProduct(x, &ym[d], L - d), ctx->Ex[L - d], ctx->Ey[d]);
+            if (SOLA_Higher(&R, &Rm)) {
+                Rm = R;
+                dm = (uint16_t) d;
+            }
+        }
+        evaluations += (last >= first) ? (last - first + 1) : 0;
+        next = last + 1;
     }
 
+    if (NULL != ctx->stats) ctx->stats->lagEvaluations += evaluations;
+
+    return dm;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SearchPitch
+
+    Description:
+        Narrow search of the lag of a frame. On voiced speech, the
+        output around y(mSs) repeats the input around x(mSa) with the
+        lag of the previous frame, shifted by Sa - Ss, so the lag of
+        the frame is usually close to that prediction. The prediction
+        drifts by Sa - Ss per frame and eventually leaves the range of
+        lags; it is then brought back by the shift between the
+        prediction and the lag of the last widened search, which is
+        about a multiple of the pitch period. Only the lags within the
+        window of the predicted one are tried, and the best one is kept
+        if its normalized cross-correlation reaches the threshold.
+
+    Parameters:
+        ctx - SOLA context (energy tables of the frame filled)
+        x - Input signal, from x(mSa)
+        ym - Output signal, from the first lag
+        L - Number of points of overlap of the first lag
+        lags - Number of lags
+        center - Index of the predicted lag, from the first one
+        dm - Index of the best lag, from the first one (pointer)
+
+    Return Value:
+        1 if the best lag of the window was accepted; otherwise 0, and
+        all the lags must be searched.
+ --------------------------------------------------------------------------*/
+
+static int SOLA_SearchPitch(sola_ctx_t *ctx, int16_t x[], int16_t ym[], uint16_t L, uint16_t lags, int32_t center,
+                            uint16_t *dm)
+{
+    sola_corr_t R, Rm = SOLA_CrossCorrelation(-1, 1, 1);
+    int32_t     d, first, last;
+
+    if (ctx->pitchJump > ctx->window) {
+        while (center > (lags - 1)) center -= ctx->pitchJump;
+        while (center < 0) center += ctx->pitchJump;
+    }
+
+    first = center - ctx->window;
+    last = center + ctx->window;
+    if (first < 0) first = 0;
+    if (last > (lags - 1)) last = lags - 1;
+
+    /*
+     * The prediction fell out of the range of lags.
+     */
+    if (first > last) {
+        return 0;
+    }
+
+    for (d = first; d <= last; d++) {
+        R = SOLA_CrossCorrelation(DSP_DotProduct(x, &ym[d], L - d), ctx->Ex[L - d], ctx->Ey[d]);
+        if (SOLA_Higher(&R, &Rm)) {
+            Rm = R;
+            *dm = (uint16_t) d;
+        }
+    }
+
+    if (NULL != ctx->stats) ctx->stats->lagEvaluations += (uint64_t) (last - first + 1);
+
+    return !SOLA_Higher(&ctx->Rt, &Rm);
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_FindLag:
+
+    Description:
+        Find the highest cross-correlation point.
+
+        The overlap between x(mSa+j) and y(mSs+k+j) always ends at the
+        same point of y, so the energies of every lag are read from the
+        tables filled once per frame by SOLA_Energies, and only the
+        numerators are computed per lag, either one lag at a time or
+        all at once from an FFT-based cross-correlation. Since the
+        samples are integers, the numerators are exact integers (the
+        FFT ones are rounded back) and all the exhaustive methods
+        select the same lag. The coarse-to-fine search only tries some
+        of the lags (see SOLA_SearchCoarse), and so does the
+        pitch-aware search, unless it has to widen to all of them (see
+        SOLA_SearchPitch).
+
+    Parameters:
+        ctx - SOLA context
+        x - Input signal, from x(mSa)
+        y - Output signal, from y(mSs)
+        pos - Index of y(mSs) in the output signal (mSs)
+        ss - Synthesis interframe interval
+ --------------------------------------------------------------------------*/
+
+static int16_t SOLA_FindLag(sola_ctx_t *ctx, int16_t x[], int16_t y[], uint64_t pos, uint16_t ss)
+{
+    uint16_t    N = ctx->N;
+    uint64_t    lastSampleIndex = ctx->lastSampleIndex;
+    int16_t     k, km = 0;
+    int16_t     *ym;
+    uint16_t    L, lags, d, dm = 0;
+    int         widened = 0, cut = 0;
+    int64_t     num;
+    sola_corr_t R, Rm = SOLA_CrossCorrelation(-1, 1, 1);
+
+    k = -((pos >= (N / 2)) ? (N / 2) : ss);
+
     /*
-     *  Obtain the interframe intervals (Sa & Ss).
+     * Number of points of overlap between y(mSs+k+j) and x(mSa+j).
      */
-    SOLA_GetIntervals(alpha, &sa, &ss);
+    L = N;
+    if (((pos + k) + N) > lastSampleIndex) {
+        L = (uint16_t) (lastSampleIndex - (pos + k));
+    }
 
     /*
-     * Allocate memory for synthetic signal.
+     * The cross-correlation function as defined will indicate a high
+     * correlation between y and x when L is small, which could lead
+     * to errant synchronization. To remedy this situation, we restricted
+     * L to taking on values greater than N / 8.
      */
-    *y = (int16_t *) malloc(((uint32_t) (xSize * alpha) + N) * sizeof(int16_t));
-    if (NULL == *y) {
-        return ENOMEM;
+    if (L < (N / 8)) {
+        return km;
+    }
+
+    lags = (uint16_t) ((N / 2) - k + 1);
+    if (lags > (L - (N / 8) + 1)) {
+        lags = (uint16_t) (L - (N / 8) + 1);
+        cut = 1;
     }
-    memset(*y, 0, ((uint32_t) (xSize * alpha) + N) * sizeof(int16_t));
 
     /*
-     * Copy the first frame to the output signal.
+     * Lag k0 + d overlaps x(mSa+j) with y(mSs+k0+d+j) on L - d points.
      */
-    memcpy(*y, x, N * sizeof(int16_t));
+    ym = &y[k];
+
+    SOLA_Energies(ctx->Ex, ctx->Ey, x, ym, L);
 
     /*
-     * Time-Scale Modification of speech.
+     * When both x and the points of y of all the lags are silent, no
+     * lag is better than another, so the search is skipped and the
+     * frame is overlapped at lag 0.
      */
-    lastSampleIndex = N;
-    maxFrames = (uint16_t) ((xSize - N) / sa);
+    if ((0 != ctx->silence) &&
+        (ctx->Ex[L] <= ctx->silenceEnergy * L) && (ctx->Ey[0] <= ctx->silenceEnergy * L)) {
+        ctx->silentFrames++;
+        if (NULL != ctx->stats) ctx->stats->silentFrames++;
+        return km;
+    }
 
-    for (m = 1; m <= maxFrames; m++) {
-        km = SOLA_FindLag(x, *y, sa, ss, m);
-        SOLA_OverlapFrame(x, *y, sa, ss, m, km);
+    if ((NULL != ctx->stats) && cut) ctx->stats->earlyExits++;
 
-        lastSampleIndex = (m * ss) + km + N;
+    if ((NULL != ctx->xd) && (((lags - 1) / ctx->decimation) >= SOLA_COARSE_MIN)) {
+        return (int16_t) (k + SOLA_SearchCoarse(ctx, x, ym, L, lags));
     }
 
-    *ySize = lastSampleIndex;
+    if ((SOLA_SEARCH_PITCH == ctx->searchMethod) && ctx->pitchValid) {
+        if (SOLA_SearchPitch(ctx, x, ym, L, lags, (int32_t) ctx->pitchLag - k, &dm)) {
+            return (int16_t) (k + dm);
+        }
+        if (NULL != ctx->stats) ctx->stats->widenedSearches++;
+        widened = 1;
+    }
 
-    return 0;
+    if (NULL != ctx->stats) ctx->stats->lagEvaluations += lags;
+
+    if (NULL != ctx->fft) {
+        DSP_CrossCorrelate(ctx->fft, x, L, ym, L, ctx->xcorr, lags);
+    }
+
+    for (d = 0; d < lags; d++, k++) {
+        /*
+         * Obtain the aligment by computing the normalized cross-correlation
+         * between x(mSa+j) and y(mSs+k+j).
+         */
+        num = (NULL != ctx->fft) ? (int64_t) floor(ctx->xcorr[d] + 0.5) : DSP_DotProduct(x, &ym[d], L - d);
+        R = SOLA_CrossCorrelation(num, ctx->Ex[L - d], ctx->Ey[d]);
+        if (SOLA_Higher(&R, &Rm)) {
+            Rm = R;
+            km = k;
+        }
+    }
+
+    if (widened) {
+        ctx->pitchJump = (uint16_t) abs(km - ctx->pitchLag);
+    }
+
+    return km;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_OverlapFrame
+
+    Description:
+        Weights and averages x(mSa+j) with y(mSs+km+j) along their
+        points of overlap. The weights are computed in integers, so
+        that the float and the SOLA_FIXED_POINT builds give the same
+        output.
+
+    Parameters:
+        ctx - SOLA context
+        x - Input signal, from x(mSa)
+        y - Output signal, from y(mSs)
+        pos - Index of y(mSs) in the output signal (mSs)
+        km - Denote the lag at which Rm(k) is maximum
+ --------------------------------------------------------------------------*/
+
+static void SOLA_OverlapFrame(sola_ctx_t *ctx, int16_t x[], int16_t y[], uint64_t pos, int16_t km)
+{
+    uint16_t N = ctx->N;
+    uint64_t lastSampleIndex = ctx->lastSampleIndex;
+    uint16_t Lm;                                /* Range of overlap */
+    uint16_t j;
+
+    Lm = N;
+    if (((pos + km) + N) > lastSampleIndex) {
+        Lm = (uint16_t) (lastSampleIndex - (pos + km));
+    }
+
+    for (j = 0; j < Lm; j++) {
+        y[km + j] = (int16_t) ((1 - j / Lm) * y[km + j] + (j / Lm) * x[j]);
+    }
+
+    if (Lm < N) {
+        memcpy(&y[km + Lm], &x[Lm], (N - Lm) * sizeof(int16_t));
+    }
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SynthesizeFrame
+
+    Description:
+        Finds the lag of a frame, overlaps the frame with the output
+        signal and updates the index of the last output sample.
+
+    Parameters:
+        ctx - SOLA context
+        x - Input signal, from x(mSa)
+        y - Output signal, from y(mSs)
+        m - Index of the frame (1 = first synthesized frame)
+        pos - Index of y(mSs) in the output signal (mSs)
+        sa - Analysis interframe interval
+        ss - Synthesis interframe interval
+ --------------------------------------------------------------------------*/
+
+static void SOLA_SynthesizeFrame(sola_ctx_t *ctx, int16_t x[], int16_t y[], uint64_t m, uint64_t pos, uint16_t sa,
+                                 uint16_t ss)
+{
+    sola_stats_t *stats = ctx->stats;
+    int32_t      half = ctx->N / 2;
+    int16_t      km;
+
+    if (1 == m) {
+        ctx->pitchValid = 0;
+        ctx->pitchJump = 0;
+    }
+
+    /*
+     * A lag from the track was found by the same search on a signal
+     * of the same length, so its overlap is always valid here.
+     */
+    if ((SOLA_LAGS_APPLY == ctx->lagMode) && (m <= ctx->lagCount)) {
+        km = ctx->lags[m - 1];
+        if (NULL != stats) stats->appliedLags++;
+    } else {
+        km = SOLA_FindLag(ctx, x, y, pos, ss);
+        if ((SOLA_LAGS_RECORD == ctx->lagMode) && (m <= ctx->lagCount)) {
+            ctx->lags[m - 1] = km;
+        }
+    }
+    SOLA_OverlapFrame(ctx, x, y, pos, km);
+
+    ctx->lastSampleIndex = pos + km + ctx->N;
+
+    /*
+     * y(mSs+km+j) now repeats x(mSa+j), so the next frame, Sa further
+     * in x, would be in step with the output at km + Sa - Ss.
+     */
+    ctx->pitchLag = (int16_t) (km + sa - ss);
+    ctx->pitchValid = 1;
+
+    ctx->frames++;
+    if (NULL != stats) {
+        stats->frames++;
+        stats->kmHistogram[((km + half) * SOLA_KM_BINS) / (2 * half + 1)]++;
+    }
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_FreeWorkspace
+
+    Description:
+        Frees the lag search workspace of a context.
+ --------------------------------------------------------------------------*/
+
+static void SOLA_FreeWorkspace(sola_ctx_t *ctx)
+{
+    DSP_FFTDestroy(ctx->fft);
+    free(ctx->xcorr);
+    free(ctx->Ex);
+    free(ctx->Ey);
+
+    ctx->fft = NULL;
+    free(ctx->xd);
+    free(ctx->yd);
+    free(ctx->Exd);
+    free(ctx->Eyd);
+
+    ctx->xcorr = NULL;
+    ctx->Ex = ctx->Ey = NULL;
+    ctx->xd = ctx->yd = NULL;
+    ctx->Exd = ctx->Eyd = NULL;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_FreeStream
+
+    Description:
+        Frees the stream buffers of a context.
+ --------------------------------------------------------------------------*/
+
+static void SOLA_FreeStream(sola_ctx_t *ctx)
+{
+    free(ctx->xBuf);
+    free(ctx->yBuf);
+
+    ctx->xBuf = ctx->yBuf = NULL;
+    ctx->capacity = 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_AllocWorkspace
+
+    Description:
+        Allocates the energy tables and, when the FFT-based lag search
+        is used, the FFT plan of a context, or the decimated frame of
+        the coarse-to-fine search. The workspace is kept until the
+        frame size or the search method changes. The cross-correlation
+        of a frame spans at most N points of x and N + 1 lags, hence 2N
+        points are enough to avoid circular aliasing.
+
+    Return Value:
+        0 on success; otherwise ENOMEM.
+ --------------------------------------------------------------------------*/
+
+static int SOLA_AllocWorkspace(sola_ctx_t *ctx)
+{
+    uint16_t N = ctx->N;
+#ifndef SOLA_FIXED_POINT
+    uint32_t size, threshold;
+#endif
+
+    if (NULL != ctx->Ex) {
+        return 0;                               /* Already allocated */
+    }
+
+    ctx->Ex = (sola_energy_t *) malloc((N + 1) * sizeof(sola_energy_t));
+    ctx->Ey = (sola_energy_t *) malloc((N + 1) * sizeof(sola_energy_t));
+    if ((NULL == ctx->Ex) || (NULL == ctx->Ey)) {
+        SOLA_FreeWorkspace(ctx);
+        return ENOMEM;
+    }
+
+    /*
+     * The decimated frame has at most N/2 points.
+     */
+    if (SOLA_SEARCH_COARSE == ctx->searchMethod) {
+        ctx->xd = (int16_t *) malloc((N / 2 + 1) * sizeof(int16_t));
+        ctx->yd = (int16_t *) malloc((N / 2 + 1) * sizeof(int16_t));
+        ctx->Exd = (sola_energy_t *) malloc((N / 2 + 1) * sizeof(sola_energy_t));
+        ctx->Eyd = (sola_energy_t *) malloc((N / 2 + 1) * sizeof(sola_energy_t));
+        if ((NULL == ctx->xd) || (NULL == ctx->yd) || (NULL == ctx->Exd) || (NULL == ctx->Eyd)) {
+            SOLA_FreeWorkspace(ctx);
+            return ENOMEM;
+        }
+        return 0;
+    }
+
+#ifndef SOLA_FIXED_POINT
+    threshold = (DSP_KERNEL_SCALAR == DSP_GetKernel()) ? SOLA_FFT_THRESHOLD : SOLA_FFT_THRESHOLD_SIMD;
+
+    if ((SOLA_SEARCH_FFT == ctx->searchMethod) ||
+        (((SOLA_SEARCH_AUTO == ctx->searchMethod) || (SOLA_SEARCH_PITCH == ctx->searchMethod)) && (N >= threshold))) {
+        for (size = 2; size < (2U * N); size <<= 1)
+            ;
+        ctx->xcorr = (double *) malloc((N + 1) * sizeof(double));
+        if ((NULL == ctx->xcorr) || (0 != DSP_FFTCreate(size, &ctx->fft))) {
+            SOLA_FreeWorkspace(ctx);
+            return ENOMEM;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_StreamBoundary
+
+    Description:
+        Returns the index of the first output sample that can still be
+        modified. A frame at mSs never reaches further back than
+        mSs - N/2, so the output signal is final up to that point for
+        the next frame and all the following ones.
+ --------------------------------------------------------------------------*/
+
+static uint64_t SOLA_StreamBoundary(sola_ctx_t *ctx)
+{
+    return (ctx->yPos >= (ctx->N / 2)) ? (ctx->yPos - (ctx->N / 2)) : 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_StreamEmit
+
+    Description:
+        Copies the final output samples, up to a given index, to the
+        caller's buffer.
+
+    Parameters:
+        ctx - SOLA context
+        end - Index of the first output sample not to copy
+        y - Caller's output buffer
+        ySize - Number of samples already in y (pointer)
+ --------------------------------------------------------------------------*/
+
+static void SOLA_StreamEmit(sola_ctx_t *ctx, uint64_t end, int16_t y[], uint32_t *ySize)
+{
+    if (end > ctx->yEmitted) {
+        memcpy(&y[*ySize], &ctx->yBuf[ctx->yEmitted - ctx->yBase], (end - ctx->yEmitted) * sizeof(int16_t));
+        *ySize += (uint32_t) (end - ctx->yEmitted);
+        ctx->yEmitted = end;
+    }
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_StreamFrames
+
+    Description:
+        Synthesizes all the frames for which the input buffer holds
+        enough samples and emits the output samples that became final.
+
+    Parameters:
+        ctx - SOLA context
+        y - Caller's output buffer
+        ySize - Number of samples already in y (pointer)
+ --------------------------------------------------------------------------*/
+
+static void SOLA_StreamFrames(sola_ctx_t *ctx, int16_t y[], uint32_t *ySize)
+{
+    uint16_t N = ctx->N;
+    uint64_t used;
+
+    /*
+     * Copy the first frame to the output signal.
+     */
+    if (0 == ctx->frame) {
+        if (ctx->xCount < N) {
+            return;
+        }
+
+        memcpy(ctx->yBuf, ctx->xBuf, N * sizeof(int16_t));
+        ctx->lastSampleIndex = N;
+        ctx->frame = 1;
+        if (NULL != ctx->alphaFn) {
+            SOLA_GetFrameIntervals(ctx, 0, &ctx->sa, &ctx->ss);
+        }
+        ctx->xPos = ctx->sa;
+        ctx->yPos = ctx->ss;
+    }
+
+    while ((ctx->xPos + N) <= (ctx->xBase + ctx->xCount)) {
+        /*
+         * Make room for the frame, which may write up to mSs + N/2 + N,
+         * by dropping the output samples already emitted.
+         */
+        if (((ctx->yPos + (N / 2) + N) - ctx->yBase) > ctx->capacity) {
+            used = ctx->lastSampleIndex - ctx->yEmitted;
+            memmove(ctx->yBuf, &ctx->yBuf[ctx->yEmitted - ctx->yBase], used * sizeof(int16_t));
+            ctx->yBase = ctx->yEmitted;
+        }
+
+        SOLA_SynthesizeFrame(ctx, &ctx->xBuf[ctx->xPos - ctx->xBase], &ctx->yBuf[ctx->yPos - ctx->yBase], ctx->frame, ctx->yPos, ctx->sa, ctx->ss);
+        if (NULL != ctx->alphaFn) {
+            SOLA_GetFrameIntervals(ctx, ctx->xPos, &ctx->sa, &ctx->ss);
+        }
+
+        ctx->frame++;
+        ctx->xPos += ctx->sa;
+        ctx->yPos += ctx->ss;
+
+        SOLA_StreamEmit(ctx, SOLA_StreamBoundary(ctx), y, ySize);
+    }
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SegmentThread
+
+    Description:
+        Worker thread of the segmented processing. It takes the next
+        segment until there are none left, and time-scales it with
+        its own context, which has the same settings as the caller's.
+ --------------------------------------------------------------------------*/
+
+static void *SOLA_SegmentThread(void *arg)
+{
+    sola_segment_job_t *job = (sola_segment_job_t *) arg;
+    sola_segment_t     *segment;
+    sola_ctx_t         *ctx;
+    sola_stats_t       stats;
+    int                err;
+
+    memset(&stats, 0, sizeof(stats));
+
+    if (0 == (err = SOLA_CtxCreate(&ctx))) {
+        SOLA_CtxSetFrameSize(ctx, job->ctx->N);
+        SOLA_CtxSetSearchMethod(ctx, job->ctx->searchMethod);
+        SOLA_CtxSetCoarseSearch(ctx, job->ctx->decimation, job->ctx->candidates);
+        SOLA_CtxSetPitchSearch(ctx, job->ctx->window, job->ctx->threshold);
+        SOLA_CtxSetSilenceThreshold(ctx, job->ctx->silence);
+        if (NULL != job->ctx->stats) {
+            SOLA_CtxSetStats(ctx, &stats);
+        }
+    }
+
+    while (0 == err) {
+        pthread_mutex_lock(&job->lock);
+        segment = ((0 == job->err) && (job->next < job->count)) ? &job->segments[job->next++] : NULL;
+        pthread_mutex_unlock(&job->lock);
+
+        if (NULL == segment) {
+            break;
+        }
+
+        err = SOLA_CtxProcess(ctx, segment->x, segment->xSize, &segment->y, &segment->ySize, job->alpha);
+    }
+
+    pthread_mutex_lock(&job->lock);
+    if ((0 != err) && (0 == job->err)) job->err = err;
+    SOLA_AddStats(&job->stats, &stats);
+    if (NULL != ctx) {
+        job->ctx->frames += ctx->frames;
+        job->ctx->silentFrames += ctx->silentFrames;
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    SOLA_CtxDestroy(ctx);
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_FindSeam
+
+    Description:
+        Finds the seam between two consecutive segments. The output
+        of the next segment nominally starts at index base of the
+        output of the previous one. Since every frame is synchronized
+        with the output synthesized so far, a segment started from
+        scratch soon falls in step with the serial output, and the two
+        outputs become identical, first possibly a few points apart
+        and then at their nominal positions. The seam is placed at the
+        first window of N points where they are identical at their
+        nominal positions, or else at the last window where they are
+        identical with a shift k in [-N/2, N/2]; the join is then
+        exact. Otherwise, the seam is placed at the end of the margin,
+        the next segment is shifted by the k with the highest
+        normalized cross-correlation between both outputs, and they
+        are crossfaded over N points.
+
+    Parameters:
+        ctx - SOLA context
+        prev and next - Consecutive segments
+        base - Nominal start of the next segment in the previous one
+ --------------------------------------------------------------------------*/
+
+static void SOLA_FindSeam(sola_ctx_t *ctx, sola_segment_t *prev, sola_segment_t *next, uint64_t base)
+{
+    uint16_t N = ctx->N;
+    uint64_t cross, last;
+    int16_t       k, km = 0;
+    int16_t       *y0, *y1;
+    sola_energy_t ex = 0, ey;
+    sola_corr_t   R, Rm = SOLA_CrossCorrelation(-1, 1, 1);
+    uint16_t      j;
+
+    /*
+     * The last frames of the previous segment are not final, as the
+     * frames that would have followed could still modify them.
+     */
+    last = prev->ySize - 3 * N;
+
+    next->fade = N;
+    for (cross = base + N; cross <= last; cross += N) {
+        for (k = -(int16_t) (N / 2); k <= (int16_t) (N / 2); k++) {
+            if (0 == memcmp(&prev->y[cross], &next->y[cross - base - k], N * sizeof(int16_t))) {
+                next->cross = cross;
+                next->fade = 0;
+                next->offset = prev->offset + (int64_t) base + k;
+                if (0 == k) {
+                    return;
+                }
+                break;
+            }
+        }
+    }
+
+    if (0 == next->fade) {
+        return;
+    }
+
+    y0 = &prev->y[last];
+    for (j = 0; j < N; j++) {
+        ex += y0[j] * y0[j];
+    }
+
+    for (k = -(int16_t) (N / 2); k <= (int16_t) (N / 2); k++) {
+        y1 = &next->y[last - base - k];
+        for (ey = 0, j = 0; j < N; j++) {
+            ey += y1[j] * y1[j];
+        }
+        R = SOLA_CrossCorrelation(DSP_DotProduct(y0, y1, N), ex, ey);
+        if (SOLA_Higher(&R, &Rm)) {
+            Rm = R;
+            km = k;
+        }
+    }
+
+    next->cross = last;
+    next->offset = prev->offset + (int64_t) base + km;
+}
+
+/*--------------------------------------------------------------------------
+    ===> PUBLIC <===
+ --------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+    SOLA_GetVersion
+
+    Description:
+        Returns the version of the library, as SOLA_VERSION. A program
+        built with another major version than the library it runs with
+        must not use it (see SOLA_VERSION_MAJOR).
+ --------------------------------------------------------------------------*/
+
+uint32_t SOLA_GetVersion(void)
+{
+    return SOLA_VERSION;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxCreate
+
+    Description:
+        Creates a SOLA context. A context holds all the settings and
+        the state of one time-scale job, so several contexts can be
+        used at the same time, e.g. from different threads. The
+        settings are initialized to their defaults (framesize = 160,
+        search method = SOLA_SEARCH_AUTO).
+
+    Return Value:
+        0 if the context was created; otherwise ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxCreate(sola_ctx_t **ctx)
+{
+    if (NULL == (*ctx = (sola_ctx_t *) calloc(1, sizeof(sola_ctx_t)))) {
+        return ENOMEM;
+    }
+
+    (*ctx)->N = SOLA_DEFAULT_FRAMESIZE;
+    (*ctx)->searchMethod = SOLA_SEARCH_AUTO;
+    (*ctx)->decimation = SOLA_DEFAULT_DECIMATION;
+    (*ctx)->candidates = SOLA_DEFAULT_CANDIDATES;
+    SOLA_CtxSetPitchSearch(*ctx, SOLA_DEFAULT_WINDOW, SOLA_DEFAULT_THRESHOLD);
+    SOLA_CtxSetSilenceThreshold(*ctx, SOLA_DEFAULT_SILENCE);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxDestroy
+
+    Description:
+        Frees a context created by SOLA_CtxCreate.
+ --------------------------------------------------------------------------*/
+
+void SOLA_CtxDestroy(sola_ctx_t *ctx)
+{
+    if (NULL == ctx) {
+        return;
+    }
+
+    SOLA_FreeWorkspace(ctx);
+    SOLA_FreeStream(ctx);
+    free(ctx);
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetFrameSize
+
+    Description:
+        Sets the size of the overlapping frames of a context.
+        The size must be greater than 1. Changing the size ends the
+        current stream, if any.
+
+    Return Value:
+        0 if the size of the frames was set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetFrameSize(sola_ctx_t *ctx, uint16_t frameSize)
+{
+    if (0 == frameSize) {
+        return EINVAL;
+    }
+
+    if (frameSize != ctx->N) {
+        SOLA_FreeWorkspace(ctx);
+        SOLA_FreeStream(ctx);
+        ctx->N = frameSize;
+    }
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetFrameSize
+
+    Description:
+        Returns the size of the overlapping frames of a context.
+ --------------------------------------------------------------------------*/
+
+uint16_t SOLA_CtxGetFrameSize(sola_ctx_t *ctx)
+{
+    return ctx->N;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetSearchMethod
+
+    Description:
+        Selects the lag search method of a context (SOLA_SEARCH_AUTO,
+        SOLA_SEARCH_DIRECT, SOLA_SEARCH_FFT, SOLA_SEARCH_COARSE or
+        SOLA_SEARCH_PITCH). All the methods but SOLA_SEARCH_COARSE and
+        SOLA_SEARCH_PITCH select the same lags, which are those of an
+        exhaustive search. When built with
+        SOLA_FIXED_POINT, the FFT-based search is replaced by the
+        direct search.
+
+    Return Value:
+        0 if the method was set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetSearchMethod(sola_ctx_t *ctx, int method)
+{
+    if ((method < SOLA_SEARCH_AUTO) || (method > SOLA_SEARCH_PITCH)) {
+        return EINVAL;
+    }
+
+    if (method != ctx->searchMethod) {
+        SOLA_FreeWorkspace(ctx);
+        ctx->searchMethod = method;
+    }
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetSearchMethod
+
+    Description:
+        Returns the lag search method of a context.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxGetSearchMethod(sola_ctx_t *ctx)
+{
+    return ctx->searchMethod;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetCoarseSearch
+
+    Description:
+        Sets the speed/quality trade-off of the coarse-to-fine search
+        (SOLA_SEARCH_COARSE). The coarse search tries one lag in
+        decimation, on signals decimated as much; the best candidates
+        are then refined at full rate. A larger decimation is faster,
+        more candidates are closer to the exhaustive search
+        (defaults = 4 and 3).
+
+    Return Value:
+        0 if the settings were set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetCoarseSearch(sola_ctx_t *ctx, uint16_t decimation, uint16_t candidates)
+{
+    if ((decimation < 2) || (decimation > SOLA_MAX_DECIMATION) ||
+        (candidates < 1) || (candidates > SOLA_MAX_CANDIDATES)) {
+        return EINVAL;
+    }
+
+    ctx->decimation = decimation;
+    ctx->candidates = candidates;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetCoarseSearch
+
+    Description:
+        Returns the settings of the coarse-to-fine search of a context.
+        Any pointer may be NULL.
+ --------------------------------------------------------------------------*/
+
+void SOLA_CtxGetCoarseSearch(sola_ctx_t *ctx, uint16_t *decimation, uint16_t *candidates)
+{
+    if (NULL != decimation) *decimation = ctx->decimation;
+    if (NULL != candidates) *candidates = ctx->candidates;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetPitchSearch
+
+    Description:
+        Sets the pitch-aware search (SOLA_SEARCH_PITCH). The lags within
+        window points of the lag predicted from the previous frame are
+        tried first; if none of them has a normalized cross-correlation
+        of at least threshold, all the lags are searched. A narrower
+        window is faster, a higher threshold widens more often and is
+        closer to the exhaustive search (defaults = 8 and 0.7).
+
+    Return Value:
+        0 if the settings were set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetPitchSearch(sola_ctx_t *ctx, uint16_t window, float threshold)
+{
+    if ((window < 1) || !((threshold >= 0.0f) && (threshold <= 1.0f))) {
+        return EINVAL;
+    }
+
+    ctx->window = window;
+    ctx->threshold = threshold;
+    ctx->Rt = SOLA_CrossCorrelation((int64_t) (threshold * 65536.0f), 65536, 65536);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetPitchSearch
+
+    Description:
+        Returns the settings of the pitch-aware search of a context.
+        Any pointer may be NULL.
+ --------------------------------------------------------------------------*/
+
+void SOLA_CtxGetPitchSearch(sola_ctx_t *ctx, uint16_t *window, float *threshold)
+{
+    if (NULL != window) *window = ctx->window;
+    if (NULL != threshold) *threshold = ctx->threshold;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetSilenceThreshold
+
+    Description:
+        Sets the silence gate of a context. A frame is silent when the
+        RMS level of its input and of the output it is overlapped with
+        are both at most level. The lag of a silent frame is not
+        searched for: the frame is overlapped at lag 0, which is where
+        the search ends up anyway when every correlation is 0. The
+        silent frames are counted, with or without statistics (see
+        SOLA_CtxGetFrameCounts). 0 turns the gate off (default).
+
+    Return Value:
+        0 if the threshold was set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetSilenceThreshold(sola_ctx_t *ctx, uint16_t level)
+{
+    if (level > INT16_MAX) {
+        return EINVAL;
+    }
+
+    ctx->silence = level;
+    ctx->silenceEnergy = (sola_energy_t) level * level;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetSilenceThreshold
+
+    Description:
+        Returns the silence gate of a context (0 = off).
+ --------------------------------------------------------------------------*/
+
+uint16_t SOLA_CtxGetSilenceThreshold(sola_ctx_t *ctx)
+{
+    return ctx->silence;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetLagTrack
+
+    Description:
+        Attaches a lag track to a context. With SOLA_LAGS_RECORD, the
+        lag found for each frame is stored in the track; with
+        SOLA_LAGS_APPLY, the lags are taken from the track instead of
+        being searched for. Applying the lags recorded on one signal to
+        other signals of the same length (e.g. the channels of a file)
+        keeps them phase-coherent. Frames beyond the end of the track
+        are processed normally. SOLA_LAGS_SEARCH detaches the track.
+
+    Parameters:
+        ctx - SOLA context
+        mode - SOLA_LAGS_SEARCH, SOLA_LAGS_RECORD or SOLA_LAGS_APPLY
+        lags - Lag track (see SOLA_CtxGetLagCount)
+        count - Number of entries in the track
+
+    Return Value:
+        0 if the track was set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetLagTrack(sola_ctx_t *ctx, int mode, int16_t lags[], uint64_t count)
+{
+    if ((SOLA_LAGS_SEARCH != mode) && (SOLA_LAGS_RECORD != mode) && (SOLA_LAGS_APPLY != mode)) {
+        return EINVAL;
+    }
+
+    if ((SOLA_LAGS_SEARCH != mode) && (NULL == lags) && (0 != count)) {
+        return EINVAL;
+    }
+
+    ctx->lagMode = mode;
+    ctx->lags = (SOLA_LAGS_SEARCH == mode) ? NULL : lags;
+    ctx->lagCount = (SOLA_LAGS_SEARCH == mode) ? 0 : count;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetLagCount
+
+    Description:
+        Returns the number of frames, hence of lags, synthesized from
+        an input signal of xSize samples (with the schedule of the
+        context, if any).
+ --------------------------------------------------------------------------*/
+
+uint64_t SOLA_CtxGetLagCount(sola_ctx_t *ctx, uint64_t xSize, float alpha)
+{
+    uint16_t sa, ss;
+
+    if (xSize < ctx->N) {
+        return 0;
+    }
+
+    if (NULL != ctx->alphaFn) {
+        return SOLA_CountFrames(ctx, xSize, NULL);
+    }
+
+    SOLA_GetIntervals(ctx, alpha, &sa, &ss);
+
+    return (xSize - ctx->N) / sa;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetSchedule
+
+    Description:
+        Gives a context a time-varying alpha. The alpha of each frame
+        is interpolated linearly between the breakpoints around the
+        frame, and is constant before the first breakpoint and after
+        the last one; two breakpoints at the same position make a
+        step. Sa & Ss are then computed for every frame, in the same
+        pass. The breakpoints must stay valid while the context uses
+        them. NULL (or a count of 0) returns to a constant alpha.
+
+    Parameters:
+        ctx - SOLA context
+        points - Breakpoints, by increasing position
+        count - Number of breakpoints
+
+    Return Value:
+        0 if the schedule was set; otherwise EINVAL if the positions
+        decrease or an alpha is not positive.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetSchedule(sola_ctx_t *ctx, const sola_breakpoint_t points[], uint32_t count)
+{
+    float    minAlpha, maxAlpha;
+    uint32_t i;
+
+    if ((NULL == points) || (0 == count)) {
+        return SOLA_CtxSetAlphaCallback(ctx, NULL, NULL, 0.0f, 0.0f);
+    }
+
+    minAlpha = maxAlpha = points[0].alpha;
+    for (i = 0; i < count; i++) {
+        if (!(points[i].alpha > 0.0f) || ((i > 0) && (points[i].position < points[i - 1].position))) {
+            return EINVAL;
+        }
+        if (points[i].alpha < minAlpha) minAlpha = points[i].alpha;
+        if (points[i].alpha > maxAlpha) maxAlpha = points[i].alpha;
+    }
+
+    SOLA_CtxSetAlphaCallback(ctx, SOLA_ScheduleAlpha, ctx, minAlpha, maxAlpha);
+    ctx->points = points;
+    ctx->pointCount = count;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetAlphaCallback
+
+    Description:
+        Gives a context a time-varying alpha computed by a callback,
+        which is called with the position of each frame in the input
+        signal, in increasing order for a given signal. Its result is
+        clamped to [minAlpha, maxAlpha], which bound the buffers of a
+        stream (see SOLA_CtxGetStreamBound). NULL returns to a
+        constant alpha.
+
+    Parameters:
+        ctx - SOLA context
+        fn - Callback (NULL = constant alpha)
+        arg - Argument of the callback
+        minAlpha & maxAlpha - Range of the callback
+
+    Return Value:
+        0 if the callback was set; otherwise EINVAL if the range is
+        not positive.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxSetAlphaCallback(sola_ctx_t *ctx, sola_alpha_fn_t fn, void *arg, float minAlpha, float maxAlpha)
+{
+    if ((NULL != fn) && !((minAlpha > 0.0f) && (minAlpha <= maxAlpha))) {
+        return EINVAL;
+    }
+
+    ctx->alphaFn = fn;
+    ctx->alphaArg = arg;
+    ctx->alphaMin = minAlpha;
+    ctx->alphaMax = maxAlpha;
+    ctx->points = NULL;
+    ctx->pointCount = 0;
+    ctx->point = 0;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxSetStats
+
+    Description:
+        Attaches statistics to a context. Every call that processes
+        samples (SOLA_CtxProcess, SOLA_CtxProcessSegmented, SOLA_CtxPush
+        and SOLA_CtxFlush) then adds its counters and the time it took
+        to them, until NULL detaches them. Nothing is collected by
+        default. The statistics belong to the caller, who should clear
+        them first; they must not be shared by contexts used from
+        different threads (see SOLA_AddStats).
+ --------------------------------------------------------------------------*/
+
+void SOLA_CtxSetStats(sola_ctx_t *ctx, sola_stats_t *stats)
+{
+    ctx->stats = stats;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetFrameCounts
+
+    Description:
+        Returns the number of frames synthesized by a context since it
+        was created, and how many of them were silent and not searched
+        (see SOLA_CtxSetSilenceThreshold). Unlike the statistics, they
+        are always counted.
+ --------------------------------------------------------------------------*/
+
+void SOLA_CtxGetFrameCounts(sola_ctx_t *ctx, uint64_t *frames, uint64_t *silentFrames)
+{
+    if (NULL != frames) *frames = ctx->frames;
+    if (NULL != silentFrames) *silentFrames = ctx->silentFrames;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_AddStats
+
+    Description:
+        Adds statistics to a total, e.g. those of the contexts of the
+        channels of a file.
+ --------------------------------------------------------------------------*/
+
+void SOLA_AddStats(sola_stats_t *total, const sola_stats_t *stats)
+{
+    int i;
+
+    total->frames += stats->frames;
+    total->lagEvaluations += stats->lagEvaluations;
+    total->earlyExits += stats->earlyExits;
+    total->appliedLags += stats->appliedLags;
+    total->widenedSearches += stats->widenedSearches;
+    total->silentFrames += stats->silentFrames;
+    for (i = 0; i < SOLA_KM_BINS; i++) {
+        total->kmHistogram[i] += stats->kmHistogram[i];
+    }
+    total->wallTime += stats->wallTime;
+    total->cpuTime += stats->cpuTime;
+    if (stats->maxBlockTime > total->maxBlockTime) total->maxBlockTime = stats->maxBlockTime;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetOutputSize
+
+    Description:
+        Returns the number of samples the synthetic signal of
+        SOLA_CtxProcessInto may need for an original signal of xSize
+        samples. It depends on the frame size and the schedule of the
+        context, which must not change before the call. The synthetic
+        signal itself is usually a little shorter.
+
+    Return Value:
+        The size of the output buffer, or 0 if the original signal is
+        smaller than the frame size.
+ --------------------------------------------------------------------------*/
+
+uint64_t SOLA_CtxGetOutputSize(sola_ctx_t *ctx, uint64_t xSize, float alpha)
+{
+    uint16_t N = ctx->N;
+    uint64_t size;
+
+    if (xSize < N) {
+        return 0;
+    }
+
+    /*
+     * With a schedule, the frames are laid out first; a frame at mSs
+     * never ends past mSs + N/2 + N.
+     */
+    if (NULL == ctx->alphaFn) {
+        size = (uint64_t) ((double) xSize * alpha) + N;
+    } else {
+        SOLA_CountFrames(ctx, xSize, &size);
+        size += (N / 2) + N;
+    }
+
+    return size;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxProcessInto
+
+    Description:
+        Time-Scale Modification of speech using SOLA, into a buffer
+        provided by the caller (e.g. one reused from file to file), of
+        at least SOLA_CtxGetOutputSize samples. Only the first ySize
+        samples are written; the rest of the buffer is left as it was.
+        With a schedule (see SOLA_CtxSetSchedule), the alpha of every
+        frame is taken from the schedule, and alpha is ignored.
+
+    Parameters:
+        ctx - SOLA context
+        x - Original signal
+        xSize - Number of samples of the original signal
+        y - Output buffer
+        yCapacity - Number of samples of the output buffer
+        ySize - Receives the number of samples of the synthetic signal
+        alpha - Time-scale factor
+
+    Return Value:
+        0 on success; otherwise EINVAL if the original signal is
+        smaller than the frame size, ENOSPC if the output buffer is too
+        small, or ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxProcessInto(sola_ctx_t *ctx, int16_t x[], uint64_t xSize, int16_t y[], uint64_t yCapacity,
+                        uint64_t *ySize, float alpha)
+{
+    uint16_t N = ctx->N;
+    uint16_t sa, ss;                            /* Interframe intervals */
+    uint64_t m, xPos, yPos;                     /* mSa & mSs */
+    uint64_t size;
+    uint64_t wall = 0, cpu = 0;
+
+    /*
+     * The size of the original signal must be greater than N.
+     */
+    if (0 == (size = SOLA_CtxGetOutputSize(ctx, xSize, alpha))) {
+        return EINVAL;
+    }
+    if (yCapacity < size) {
+        return ENOSPC;
+    }
+
+    if (NULL != ctx->stats) SOLA_Clock(&wall, &cpu);
+
+    /*
+     * Obtain the interframe intervals (Sa & Ss).
+     */
+    if (NULL == ctx->alphaFn) {
+        SOLA_GetIntervals(ctx, alpha, &sa, &ss);
+    } else {
+        SOLA_GetFrameIntervals(ctx, 0, &sa, &ss);
+    }
+
+    /*
+     * Allocate the lag search workspace.
+     */
+    if (0 != SOLA_AllocWorkspace(ctx)) {
+        return ENOMEM;
+    }
+
+    /*
+     * Copy the first frame to the output signal. Every frame is then
+     * overlapped with samples already written, and copied past them,
+     * so the output buffer needs no clearing.
+     */
+    memcpy(y, x, N * sizeof(int16_t));
+
+    /*
+     * Time-Scale Modification of speech.
+     */
+    ctx->lastSampleIndex = N;
+
+    for (m = 1, xPos = sa, yPos = ss; (xPos + N) <= xSize; m++) {
+        SOLA_SynthesizeFrame(ctx, &x[xPos], &y[yPos], m, yPos, sa, ss);
+        if (NULL != ctx->alphaFn) {
+            SOLA_GetFrameIntervals(ctx, xPos, &sa, &ss);
+        }
+        xPos += sa;
+        yPos += ss;
+    }
+
+    *ySize = ctx->lastSampleIndex;
+
+    if (NULL != ctx->stats) SOLA_AddTime(ctx, wall, cpu);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxProcess
+
+    Description:
+        Time-Scale Modification of speech using SOLA. The synthetic
+        signal is allocated by the function and must be freed by the
+        caller (see SOLA_CtxProcessInto to provide it instead).
+
+    Return Value:
+        0 on success; otherwise EINVAL if the original signal is
+        smaller than the frame size, or ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxProcess(sola_ctx_t *ctx, int16_t x[], uint64_t xSize, int16_t *y[], uint64_t *ySize, float alpha)
+{
+    uint64_t size;
+    int      err;
+
+    if (0 == (size = SOLA_CtxGetOutputSize(ctx, xSize, alpha))) {
+        return EINVAL;
+    }
+
+    /*
+     * Allocate memory for synthetic signal.
+     */
+    if ((size > (SIZE_MAX / sizeof(int16_t))) || (NULL == (*y = (int16_t *) malloc((size_t) size * sizeof(int16_t))))) {
+        return ENOMEM;
+    }
+
+    if (0 != (err = SOLA_CtxProcessInto(ctx, x, xSize, *y, size, ySize, alpha))) {
+        free(*y);
+    }
+
+    return err;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxProcessSegmented
+
+    Description:
+        Time-Scale Modification of speech using SOLA, in parallel. The
+        input is split into segments of about segmentSize samples,
+        which are time-scaled independently on a number of worker
+        threads. Each segment runs some way past the start of the next
+        one, and the outputs are joined where they coincide, or else
+        aligned by cross-correlation and crossfaded (see
+        SOLA_FindSeam). The result is usually identical to the output
+        of SOLA_CtxProcess, but is not guaranteed to be. The lag track
+        of the context is not used, and a schedule is not supported.
+
+    Parameters:
+        ctx - SOLA context (settings of the segments)
+        x - Input signal
+        xSize - Number of samples of x
+        y - Synthetic signal, allocated by the function (pointer)
+        ySize - Number of samples of y (pointer)
+        alpha - Time-scale factor
+        segmentSize - Input samples per segment (rounded up to a
+                      multiple of Sa, and to at least a few frames)
+        threads - Number of worker threads (1 or more)
+
+    Return Value:
+        0 on success; otherwise EINVAL if the original signal is
+        smaller than the frame size, threads is 0 or the context has a
+        schedule, ENOMEM, or EAGAIN if no thread could be started.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxProcessSegmented(sola_ctx_t *ctx, int16_t x[], uint64_t xSize, int16_t *y[], uint64_t *ySize,
+                             float alpha, uint64_t segmentSize, uint32_t threads)
+{
+    uint16_t           N = ctx->N;
+    uint16_t           sa, ss;                  /* Interframe intervals */
+    sola_segment_job_t job;
+    sola_segment_t     *segments, *segment, *next;
+    pthread_t          *workers;
+    uint64_t           margin, base, from, start, size;
+    uint64_t           wall = 0, cpu = 0;
+    int64_t            shift;
+    uint32_t           count, started = 0, s;
+    uint16_t           j;
+
+    if ((xSize < N) || (0 == threads) || (NULL != ctx->alphaFn)) {
+        return EINVAL;
+    }
+
+    SOLA_GetIntervals(ctx, alpha, &sa, &ss);
+
+    /*
+     * Segments start on a multiple of Sa, so that their frames fall on
+     * the same input samples as in SOLA_CtxProcess. A short remainder
+     * is merged with the last segment.
+     */
+    if (segmentSize < (SOLA_SEGMENT_MIN * N)) {
+        segmentSize = SOLA_SEGMENT_MIN * N;
+    }
+    segmentSize = ((segmentSize + sa - 1) / sa) * sa;
+    margin = ((((SOLA_SEAM_MARGIN + 4) * N) + ss - 1) / ss + 1) * sa;
+
+    count = (xSize > segmentSize) ? (uint32_t) (xSize / segmentSize) : 1;
+    if ((count > 1) && ((xSize - (count - 1) * segmentSize) < (segmentSize + margin))) {
+        count--;
+    }
+
+    /*
+     * A single segment is just the serial processing.
+     */
+    if (1 == count) {
+        return SOLA_CtxProcess(ctx, x, xSize, y, ySize, alpha);
+    }
+
+    if (NULL == (segments = (sola_segment_t *) calloc(count, sizeof(sola_segment_t)))) {
+        return ENOMEM;
+    }
+
+    if (NULL != ctx->stats) SOLA_Clock(&wall, &cpu);
+
+    for (s = 0; s < count; s++) {
+        start = s * segmentSize;
+        segments[s].x = &x[start];
+        segments[s].xSize = (s < (count - 1)) ? (segmentSize + margin) : (xSize - start);
+    }
+
+    /*
+     * Time-scale the segments on the worker threads.
+     */
+    job.ctx = ctx;
+    job.segments = segments;
+    job.count = count;
+    job.next = 0;
+    job.alpha = alpha;
+    job.err = 0;
+    memset(&job.stats, 0, sizeof(job.stats));
+    pthread_mutex_init(&job.lock, NULL);
+
+    if (threads > count) threads = count;
+    if (NULL == (workers = (pthread_t *) malloc(threads * sizeof(pthread_t)))) {
+        job.err = ENOMEM;
+    } else {
+        for (s = 0; s < threads; s++) {
+            if (0 == pthread_create(&workers[started], NULL, SOLA_SegmentThread, &job)) {
+                started++;
+            }
+        }
+        if (0 == started) {
+            job.err = EAGAIN;
+        }
+        for (s = 0; s < started; s++) {
+            pthread_join(workers[s], NULL);
+        }
+        free(workers);
+    }
+
+    pthread_mutex_destroy(&job.lock);
+
+    /*
+     * Find the seam of each segment with the previous one. The next
+     * segment nominally starts at the output of the frame of the
+     * previous one that falls on its first input sample.
+     */
+    base = (segmentSize / sa) * ss;
+    for (s = 1; (s < count) && (0 == job.err); s++) {
+        if ((segments[s - 1].ySize < (base + 5 * N)) || (segments[s].ySize < (margin + 2 * N))) {
+            job.err = EINVAL;
+            break;
+        }
+        SOLA_FindSeam(ctx, &segments[s - 1], &segments[s], base);
+    }
+
+    size = 0;
+    if (0 == job.err) {
+        size = (uint64_t) segments[count - 1].offset + segments[count - 1].ySize;
+        if ((size > (SIZE_MAX / sizeof(int16_t))) || (NULL == (*y = (int16_t *) malloc((size_t) size * sizeof(int16_t))))) {
+            job.err = ENOMEM;
+        }
+    }
+
+    /*
+     * Stitch the segments together.
+     */
+    if (0 == job.err) {
+        from = 0;
+        for (s = 0; s < count; s++) {
+            segment = &segments[s];
+            if (s == (count - 1)) {
+                memcpy(&(*y)[segment->offset + from], &segment->y[from], (segment->ySize - from) * sizeof(int16_t));
+                break;
+            }
+
+            next = &segments[s + 1];
+            memcpy(&(*y)[segment->offset + from], &segment->y[from], (next->cross - from) * sizeof(int16_t));
+
+            shift = next->offset - segment->offset;
+            for (j = 0; j < next->fade; j++) {
+                (*y)[segment->offset + next->cross + j] = (int16_t) (((next->fade - j) * segment->y[next->cross + j] +
+                                                                      j * next->y[next->cross - shift + j]) / next->fade);
+            }
+            from = next->cross - shift + next->fade;
+        }
+        *ySize = size;
+    }
+
+    for (s = 0; s < count; s++) {
+        free(segments[s].y);
+    }
+    free(segments);
+
+    /*
+     * The CPU time of the workers adds up, but their elapsed time is
+     * covered by that of the call.
+     */
+    if (NULL != ctx->stats) {
+        job.stats.wallTime = 0;
+        SOLA_AddStats(ctx->stats, &job.stats);
+        SOLA_AddTime(ctx, wall, cpu);
+    }
+
+    return job.err;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxBegin
+
+    Description:
+        Starts a stream. The input signal is then given in chunks of
+        any size to SOLA_CtxPush, and the stream is ended by
+        SOLA_CtxFlush. The output is identical to SOLA_CtxProcess over
+        the whole input, but it is produced as soon as it is final and
+        the memory used is bounded to a few frames. With a schedule,
+        alpha is ignored.
+
+    Return Value:
+        0 on success; otherwise ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxBegin(sola_ctx_t *ctx, float alpha)
+{
+    uint32_t capacity = SOLA_STREAM_FRAMES * ctx->N;
+
+    if (0 != SOLA_AllocWorkspace(ctx)) {
+        return ENOMEM;
+    }
+
+    if (capacity != ctx->capacity) {
+        SOLA_FreeStream(ctx);
+        ctx->xBuf = (int16_t *) malloc(capacity * sizeof(int16_t));
+        ctx->yBuf = (int16_t *) malloc(capacity * sizeof(int16_t));
+        if ((NULL == ctx->xBuf) || (NULL == ctx->yBuf)) {
+            SOLA_FreeStream(ctx);
+            return ENOMEM;
+        }
+        ctx->capacity = capacity;
+    }
+
+    /*
+     * With a schedule, the intervals are those of the current frame.
+     */
+    SOLA_GetIntervals(ctx, alpha, &ctx->sa, &ctx->ss);
+
+    ctx->frame = 0;
+    ctx->xPos = ctx->yPos = 0;
+    ctx->xBase = ctx->xCount = 0;
+    ctx->yBase = ctx->yEmitted = 0;
+    ctx->blockSize = 0;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetStreamBound
+
+    Description:
+        Returns the largest number of output samples produced by
+        SOLA_CtxPush for a chunk of xSize input samples, or by
+        SOLA_CtxFlush when xSize is 0. The output buffers given to
+        those functions must be at least that large.
+ --------------------------------------------------------------------------*/
+
+uint32_t SOLA_CtxGetStreamBound(sola_ctx_t *ctx, uint32_t xSize)
+{
+    uint16_t sa = ctx->sa, ss = ctx->ss;
+
+    /*
+     * With a schedule, the shortest Sa (that of the largest alpha) and
+     * the longest Ss, which is never over N/2.
+     */
+    if (NULL != ctx->alphaFn) {
+        SOLA_GetIntervals(ctx, ctx->alphaMax, &sa, &ss);
+        if (0 == sa) sa = 1;
+        ss = ctx->N / 2;
+    }
+
+    return ((xSize / sa) + 2) * ss + (2 * ctx->N);
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxPush
+
+    Description:
+        Gives the next chunk of the input signal to a stream, and
+        returns the output samples that became final.
+
+    Parameters:
+        ctx - SOLA context
+        x - Chunk of the input signal
+        xSize - Number of samples in the chunk
+        y - Output samples (see SOLA_CtxGetStreamBound)
+        ySize - Number of output samples (pointer)
+
+    Return Value:
+        0 on success; otherwise EINVAL if no stream was started,
+        or ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxPush(sola_ctx_t *ctx, int16_t x[], uint32_t xSize, int16_t y[], uint32_t *ySize)
+{
+    uint32_t n, drop;
+    uint64_t wall = 0, cpu = 0;
+
+    *ySize = 0;
+
+    if (NULL == ctx->xBuf) {
+        return EINVAL;
+    }
+
+    if (0 != SOLA_AllocWorkspace(ctx)) {
+        return ENOMEM;
+    }
+
+    if (NULL != ctx->stats) SOLA_Clock(&wall, &cpu);
+
+    while (xSize > 0) {
+        /*
+         * Drop the input samples that precede the next frame.
+         */
+        if (ctx->xPos > ctx->xBase) {
+            drop = (ctx->xPos - ctx->xBase > ctx->xCount) ? ctx->xCount : (uint32_t) (ctx->xPos - ctx->xBase);
+            memmove(ctx->xBuf, &ctx->xBuf[drop], (ctx->xCount - drop) * sizeof(int16_t));
+            ctx->xBase += drop;
+            ctx->xCount -= drop;
+        }
+
+        n = ctx->capacity - ctx->xCount;
+        if (n > xSize) n = xSize;
+
+        memcpy(&ctx->xBuf[ctx->xCount], x, n * sizeof(int16_t));
+        ctx->xCount += n;
+        x += n;
+        xSize -= n;
+
+        SOLA_StreamFrames(ctx, y, ySize);
+    }
+
+    if (NULL != ctx->stats) SOLA_AddTime(ctx, wall, cpu);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxFlush
+
+    Description:
+        Ends a stream and returns the remaining output samples.
+
+    Parameters:
+        ctx - SOLA context
+        y - Output samples (see SOLA_CtxGetStreamBound)
+        ySize - Number of output samples (pointer)
+
+    Return Value:
+        0 on success; otherwise EINVAL if no stream was started or if
+        the input signal was smaller than the frame size.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxFlush(sola_ctx_t *ctx, int16_t y[], uint32_t *ySize)
+{
+    uint64_t wall = 0, cpu = 0;
+
+    *ySize = 0;
+
+    if ((NULL == ctx->xBuf) || (0 == ctx->frame)) {
+        return EINVAL;
+    }
+
+    if (NULL != ctx->stats) SOLA_Clock(&wall, &cpu);
+
+    SOLA_StreamEmit(ctx, ctx->lastSampleIndex, y, ySize);
+
+    if (NULL != ctx->stats) SOLA_AddTime(ctx, wall, cpu);
+
+    ctx->frame = 0;
+    ctx->xBase = ctx->xCount = ctx->xPos = 0;
+    ctx->blockSize = 0;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxRealtimeBegin
+
+    Description:
+        Starts a realtime stream, a stream (see SOLA_CtxBegin) given
+        in blocks of at most blockSize samples. All the memory is
+        allocated here: SOLA_CtxRealtimeProcess never allocates, and
+        synthesizes at most blockSize / Sa + 1 frames per block, so its
+        work per block is bounded. The output of a block is at most
+        SOLA_CtxGetStreamBound(ctx, blockSize) samples, and trails the
+        input by at most SOLA_CtxGetLatency(ctx) samples. The stream
+        is ended by SOLA_CtxFlush.
+
+        The search methods SOLA_SEARCH_COARSE & SOLA_SEARCH_PITCH are
+        faster on average, but in the worst case they do the work of
+        an exhaustive search, on which a realtime budget should be
+        based.
+
+    Return Value:
+        0 on success; otherwise EINVAL if blockSize is 0, or ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxRealtimeBegin(sola_ctx_t *ctx, float alpha, uint32_t blockSize)
+{
+    int err;
+
+    if (0 == blockSize) {
+        return EINVAL;
+    }
+
+    if (0 != (err = SOLA_CtxBegin(ctx, alpha))) {
+        return err;
+    }
+
+    ctx->blockSize = blockSize;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxGetLatency
+
+    Description:
+        Returns the algorithmic latency of a realtime stream: the
+        largest number of input samples that can be given after a
+        sample before its output is returned, an output sample standing
+        for Sa/Ss input samples.
+
+        After frame m, the input holds less than (m+1)Sa + N samples,
+        and the output is final up to (m+1)Ss - N/2 (see
+        SOLA_StreamBoundary), i.e. up to (m+1)Sa - (N/2)(Sa/Ss) of the
+        input. A sample may then wait for up to a block of input.
+ --------------------------------------------------------------------------*/
+
+uint32_t SOLA_CtxGetLatency(sola_ctx_t *ctx)
+{
+    uint16_t sa = ctx->sa, ss = ctx->ss;
+
+    /*
+     * With a schedule, Sa/Ss is the largest for the smallest alpha.
+     */
+    if (NULL != ctx->alphaFn) {
+        SOLA_GetIntervals(ctx, ctx->alphaMin, &sa, &ss);
+    }
+    if (0 == ss) ss = 1;
+
+    return ctx->N + ((uint32_t) (ctx->N / 2) * sa + ss - 1) / ss + ctx->blockSize - 1;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_CtxRealtimeProcess
+
+    Description:
+        Gives the next block of the input signal to a realtime stream,
+        and returns the output samples that became final. The longest
+        block is kept in the statistics of the context.
+
+    Parameters:
+        ctx - SOLA context
+        x - Block of the input signal
+        xSize - Number of samples in the block, at most blockSize
+        y - Output samples (see SOLA_CtxGetStreamBound)
+        ySize - Number of output samples (pointer)
+
+    Return Value:
+        0 on success; otherwise EINVAL if no realtime stream was
+        started or if the block is too large.
+ --------------------------------------------------------------------------*/
+
+int SOLA_CtxRealtimeProcess(sola_ctx_t *ctx, int16_t x[], uint32_t xSize, int16_t y[], uint32_t *ySize)
+{
+    uint64_t start = 0, end, cpu;
+    int      err;
+
+    *ySize = 0;
+
+    if ((0 == ctx->blockSize) || (xSize > ctx->blockSize)) {
+        return EINVAL;
+    }
+
+    if (NULL != ctx->stats) SOLA_Clock(&start, &cpu);
+
+    err = SOLA_CtxPush(ctx, x, xSize, y, ySize);
+
+    if (NULL != ctx->stats) {
+        SOLA_Clock(&end, &cpu);
+        if ((end - start) > ctx->stats->maxBlockTime) ctx->stats->maxBlockTime = end - start;
+    }
+
+    return err;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_EstimatePeriod
+
+    Description:
+        Estimates the period of a signal from its normalized
+        autocorrelation: the first xSize - maxPeriod points are
+        correlated with themselves shifted by each period, and the
+        shortest period at a peak of at least threshold is returned.
+        Taking the first peak rather than the highest one avoids
+        picking a multiple of the period. The comparisons are those of
+        the lag search, so they are exact with SOLA_FIXED_POINT.
+
+    Parameters:
+        x - Signal, at least 2 * maxPeriod points
+        xSize - Number of points of the signal
+        minPeriod & maxPeriod - Range of periods (points)
+        threshold - Lowest correlation of a period
+
+    Return Value:
+        The period; otherwise 0 if the signal has none within the
+        range (silence, noise), or if it is too short.
+ --------------------------------------------------------------------------*/
+
+uint16_t SOLA_EstimatePeriod(int16_t x[], uint32_t xSize, uint16_t minPeriod, uint16_t maxPeriod, float threshold)
+{
+    sola_corr_t Rt = SOLA_CrossCorrelation((int64_t) (threshold * 65536.0f), 65536, 65536);
+    sola_corr_t R, R1, R2;                     /* R(p), R(p - 1) & R(p - 2) */
+    uint32_t    W, j;
+    uint16_t    p;
+    int64_t     e0 = 0, ep = 0;
+
+    if ((0 == minPeriod) || (minPeriod >= maxPeriod) || (xSize < 2U * maxPeriod)) {
+        return 0;
+    }
+    W = xSize - maxPeriod;
+
+    for (j = 0; j < W; j++) {
+        e0 += x[j] * x[j];
+    }
+    for (j = minPeriod - 1; j < (minPeriod - 1) + W; j++) {
+        ep += x[j] * x[j];
+    }
+
+    /*
+     * Slide the energy of the shifted points along, and keep the last
+     * two correlations to find the peaks.
+     */
+    R2 = R1 = SOLA_CrossCorrelation(DSP_DotProduct(x, &x[minPeriod - 1], W), e0, ep);
+    for (p = minPeriod; p <= maxPeriod; p++) {
+        ep += x[p - 1 + W] * x[p - 1 + W] - x[p - 1] * x[p - 1];
+        R = SOLA_CrossCorrelation(DSP_DotProduct(x, &x[p], W), e0, ep);
+
+        /*
+         * A peak at p - 1.
+         */
+        if ((p > minPeriod) && SOLA_Higher(&R1, &R2) && !SOLA_Higher(&R, &R1) && !SOLA_Higher(&Rt, &R1)) {
+            return (uint16_t) (p - 1);
+        }
+
+        R2 = R1;
+        R1 = R;
+    }
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SetFrameSize
+
+    Description:
+        Call this function to set the size of the overlapping frames
+        used by SOLA_TSM. The size must be greater than 1
+        (default = 160 ).
+
+    Return Value:
+        0 if the size of the frames was set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_SetFrameSize(uint16_t frameSize)
+{
+    if (0 == frameSize) {
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&defaultLock);
+    defaultFrameSize = frameSize;
+    pthread_mutex_unlock(&defaultLock);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_GetFrameSize
+
+    Description:
+        Returns the size of the overlapping frames used by SOLA_TSM.
+ --------------------------------------------------------------------------*/
+
+uint16_t SOLA_GetFrameSize(void)
+{
+    uint16_t frameSize;
+
+    pthread_mutex_lock(&defaultLock);
+    frameSize = defaultFrameSize;
+    pthread_mutex_unlock(&defaultLock);
+
+    return frameSize;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SetSearchMethod
+
+    Description:
+        Call this function to select the lag search method used by
+        SOLA_TSM (see SOLA_CtxSetSearchMethod).
+
+    Return Value:
+        0 if the method was set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_SetSearchMethod(int method)
+{
+    if ((method < SOLA_SEARCH_AUTO) || (method > SOLA_SEARCH_PITCH)) {
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&defaultLock);
+    defaultSearchMethod = method;
+    pthread_mutex_unlock(&defaultLock);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_GetSearchMethod
+
+    Description:
+        Returns the lag search method used by SOLA_TSM.
+ --------------------------------------------------------------------------*/
+
+int SOLA_GetSearchMethod(void)
+{
+    int method;
+
+    pthread_mutex_lock(&defaultLock);
+    method = defaultSearchMethod;
+    pthread_mutex_unlock(&defaultLock);
+
+    return method;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SetCoarseSearch
+
+    Description:
+        Call this function to set the coarse-to-fine search used by
+        SOLA_TSM (see SOLA_CtxSetCoarseSearch).
+
+    Return Value:
+        0 if the settings were set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_SetCoarseSearch(uint16_t decimation, uint16_t candidates)
+{
+    if ((decimation < 2) || (decimation > SOLA_MAX_DECIMATION) ||
+        (candidates < 1) || (candidates > SOLA_MAX_CANDIDATES)) {
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&defaultLock);
+    defaultDecimation = decimation;
+    defaultCandidates = candidates;
+    pthread_mutex_unlock(&defaultLock);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SetPitchSearch
+
+    Description:
+        Call this function to set the pitch-aware search used by
+        SOLA_TSM (see SOLA_CtxSetPitchSearch).
+
+    Return Value:
+        0 if the settings were set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_SetPitchSearch(uint16_t window, float threshold)
+{
+    if ((window < 1) || !((threshold >= 0.0f) && (threshold <= 1.0f))) {
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&defaultLock);
+    defaultWindow = window;
+    defaultThreshold = threshold;
+    pthread_mutex_unlock(&defaultLock);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SetSilenceThreshold
+
+    Description:
+        Call this function to set the silence gate used by SOLA_TSM
+        (see SOLA_CtxSetSilenceThreshold).
+
+    Return Value:
+        0 if the threshold was set; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int SOLA_SetSilenceThreshold(uint16_t level)
+{
+    if (level > INT16_MAX) {
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&defaultLock);
+    defaultSilence = level;
+    pthread_mutex_unlock(&defaultLock);
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_SetStats
+
+    Description:
+        Call this function to collect the statistics of SOLA_TSM (see
+        SOLA_CtxSetStats). NULL stops the collection.
+ --------------------------------------------------------------------------*/
+
+void SOLA_SetStats(sola_stats_t *stats)
+{
+    pthread_mutex_lock(&defaultLock);
+    defaultStats = stats;
+    pthread_mutex_unlock(&defaultLock);
+}
+
+/*--------------------------------------------------------------------------
+    SOLA_TSM
+
+    Description:
+        Time-Scale Modification of speech using SOLA, with the settings
+        of SOLA_SetFrameSize, SOLA_SetSearchMethod, SOLA_SetCoarseSearch,
+        SOLA_SetPitchSearch, SOLA_SetSilenceThreshold & SOLA_SetStats.
+        This is a wrapper around a temporary context
+        (see SOLA_CtxProcess), which returns EOVERFLOW if the synthetic
+        signal has more than 2^32 - 1 samples. The settings are read
+        under a lock, so they may be changed while other threads call
+        this function; a call uses those in effect when it starts.
+ --------------------------------------------------------------------------*/
+
+int SOLA_TSM(int16_t x[], uint32_t xSize, int16_t *y[], uint32_t *ySize, float alpha)
+{
+    sola_ctx_t *ctx;
+    uint64_t   size;
+    int        err;
+
+    if (0 != (err = SOLA_CtxCreate(&ctx))) {
+        return err;
+    }
+
+    pthread_mutex_lock(&defaultLock);
+    SOLA_CtxSetFrameSize(ctx, defaultFrameSize);
+    SOLA_CtxSetSearchMethod(ctx, defaultSearchMethod);
+    SOLA_CtxSetCoarseSearch(ctx, defaultDecimation, defaultCandidates);
+    SOLA_CtxSetPitchSearch(ctx, defaultWindow, defaultThreshold);
+    SOLA_CtxSetSilenceThreshold(ctx, defaultSilence);
+    SOLA_CtxSetStats(ctx, defaultStats);
+    pthread_mutex_unlock(&defaultLock);
+
+    if (0 == (err = SOLA_CtxProcess(ctx, x, xSize, y, &size, alpha))) {
+        if (size > UINT32_MAX) {
+            free(*y);
+            err = EOVERFLOW;
+        } else {
+            *ySize = (uint32_t) size;
+        }
+    }
+
+    SOLA_CtxDestroy(ctx);
+
+    return err;
 }
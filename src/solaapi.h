@@ -18,12 +18,103 @@
 extern "C" {                                    /* Assume C declarations for C++ */
 #endif /* __cplusplus */
 
+/*--------------------------------------------------------------------------
+    General constants and data types
+ --------------------------------------------------------------------------*/
+
+#define SOLA_VERSION_MAJOR  1                   /* Incompatible changes of the API */
+#define SOLA_VERSION_MINOR  0                   /* Functions added */
+#define SOLA_VERSION_PATCH  0                   /* Fixes */
+#define SOLA_VERSION        ((SOLA_VERSION_MAJOR << 16) | (SOLA_VERSION_MINOR << 8) | SOLA_VERSION_PATCH)
+
+#define SOLA_SEARCH_AUTO    0                   /* FFT for large frame sizes */
+#define SOLA_SEARCH_DIRECT  1                   /* Brute-force search */
+#define SOLA_SEARCH_FFT     2                   /* FFT-based search */
+#define SOLA_SEARCH_COARSE  3                   /* Coarse-to-fine search (approximate) */
+#define SOLA_SEARCH_PITCH   4                   /* Around the previous lag (approximate) */
+
+#define SOLA_MAX_DECIMATION 16                  /* See SOLA_CtxSetCoarseSearch */
+#define SOLA_MAX_CANDIDATES 8
+
+#define SOLA_LAGS_SEARCH    0                   /* Search the lag of every frame */
+#define SOLA_LAGS_RECORD    1                   /* Search and record the lags */
+#define SOLA_LAGS_APPLY     2                   /* Use the recorded lags */
+
+#define SOLA_KM_BINS        16                  /* Bins of the lag histogram */
+
+typedef struct sola_ctx sola_ctx_t;             /* Opaque SOLA context */
+
+struct sola_stats {
+    uint64_t frames;                            /* Frames synthesized */
+    uint64_t lagEvaluations;                    /* Cross-correlations computed */
+    uint64_t earlyExits;                        /* Searches cut short (L - d < N/8) */
+    uint64_t appliedLags;                       /* Lags taken from a lag track */
+    uint64_t widenedSearches;                   /* Pitch searches widened to all lags */
+    uint64_t silentFrames;                      /* Frames not searched (silent) */
+    uint64_t kmHistogram[SOLA_KM_BINS];         /* Lags from -N/2 to N/2, equal bins */
+    uint64_t wallTime;                          /* Elapsed time (ns) */
+    uint64_t cpuTime;                           /* CPU time (ns) */
+    uint64_t maxBlockTime;                      /* Longest realtime block (ns) */
+};
+
+typedef struct sola_stats sola_stats_t;
+
+struct sola_breakpoint {
+    uint64_t position;                          /* Input sample */
+    float    alpha;                             /* Time-scale factor at that sample */
+};
+
+typedef struct sola_breakpoint sola_breakpoint_t;
+
+typedef float (*sola_alpha_fn_t)(void *arg, uint64_t position);
+
 /*--------------------------------------------------------------------------
     Prototypes
  --------------------------------------------------------------------------*/
 
+uint32_t SOLA_GetVersion(void);
+int SOLA_CtxCreate(sola_ctx_t **ctx);
+void SOLA_CtxDestroy(sola_ctx_t *ctx);
+int SOLA_CtxSetFrameSize(sola_ctx_t *ctx, uint16_t frameSize);
+uint16_t SOLA_CtxGetFrameSize(sola_ctx_t *ctx);
+int SOLA_CtxSetSearchMethod(sola_ctx_t *ctx, int method);
+int SOLA_CtxGetSearchMethod(sola_ctx_t *ctx);
+int SOLA_CtxSetCoarseSearch(sola_ctx_t *ctx, uint16_t decimation, uint16_t candidates);
+void SOLA_CtxGetCoarseSearch(sola_ctx_t *ctx, uint16_t *decimation, uint16_t *candidates);
+int SOLA_CtxSetPitchSearch(sola_ctx_t *ctx, uint16_t window, float threshold);
+void SOLA_CtxGetPitchSearch(sola_ctx_t *ctx, uint16_t *window, float *threshold);
+int SOLA_CtxSetSilenceThreshold(sola_ctx_t *ctx, uint16_t level);
+uint16_t SOLA_CtxGetSilenceThreshold(sola_ctx_t *ctx);
+int SOLA_CtxSetSchedule(sola_ctx_t *ctx, const sola_breakpoint_t points[], uint32_t count);
+int SOLA_CtxSetAlphaCallback(sola_ctx_t *ctx, sola_alpha_fn_t fn, void *arg, float minAlpha, float maxAlpha);
+int SOLA_CtxSetLagTrack(sola_ctx_t *ctx, int mode, int16_t lags[], uint64_t count);
+uint64_t SOLA_CtxGetLagCount(sola_ctx_t *ctx, uint64_t xSize, float alpha);
+void SOLA_CtxSetStats(sola_ctx_t *ctx, sola_stats_t *stats);
+void SOLA_CtxGetFrameCounts(sola_ctx_t *ctx, uint64_t *frames, uint64_t *silentFrames);
+void SOLA_AddStats(sola_stats_t *total, const sola_stats_t *stats);
+uint64_t SOLA_CtxGetOutputSize(sola_ctx_t *ctx, uint64_t xSize, float alpha);
+int SOLA_CtxProcessInto(sola_ctx_t *ctx, int16_t x[], uint64_t xSize, int16_t y[], uint64_t yCapacity,
+                        uint64_t *ySize, float alpha);
+int SOLA_CtxProcess(sola_ctx_t *ctx, int16_t x[], uint64_t xSize, int16_t *y[], uint64_t *ySize, float alpha);
+int SOLA_CtxProcessSegmented(sola_ctx_t *ctx, int16_t x[], uint64_t xSize, int16_t *y[], uint64_t *ySize,
+                             float alpha, uint64_t segmentSize, uint32_t threads);
+int SOLA_CtxBegin(sola_ctx_t *ctx, float alpha);
+uint32_t SOLA_CtxGetStreamBound(sola_ctx_t *ctx, uint32_t xSize);
+int SOLA_CtxPush(sola_ctx_t *ctx, int16_t x[], uint32_t xSize, int16_t y[], uint32_t *ySize);
+int SOLA_CtxFlush(sola_ctx_t *ctx, int16_t y[], uint32_t *ySize);
+int SOLA_CtxRealtimeBegin(sola_ctx_t *ctx, float alpha, uint32_t blockSize);
+uint32_t SOLA_CtxGetLatency(sola_ctx_t *ctx);
+int SOLA_CtxRealtimeProcess(sola_ctx_t *ctx, int16_t x[], uint32_t xSize, int16_t y[], uint32_t *ySize);
+uint16_t SOLA_EstimatePeriod(int16_t x[], uint32_t xSize, uint16_t minPeriod, uint16_t maxPeriod, float threshold);
+
 int SOLA_SetFrameSize(uint16_t frameSize);
 uint16_t SOLA_GetFrameSize(void);
+int SOLA_SetSearchMethod(int method);
+int SOLA_GetSearchMethod(void);
+int SOLA_SetCoarseSearch(uint16_t decimation, uint16_t candidates);
+int SOLA_SetPitchSearch(uint16_t window, float threshold);
+int SOLA_SetSilenceThreshold(uint16_t level);
+void SOLA_SetStats(sola_stats_t *stats);
 int SOLA_TSM(int16_t x[], uint32_t xSize, int16_t *y[], uint32_t *ySize, float alpha);
 
 #ifdef __cplusplus
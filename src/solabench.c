@@ -0,0 +1,411 @@
+/*--------------------------------------------------------------------------
+    FILE                :   solabench.c
+
+    PURPOSE             :   Benchmark of the TSM engine on deterministic
+                            synthetic signals (read, TSM and write timed
+                            separately)
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "typedef.h"
+#include "ulawapi.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SAMPLE_RATE   8000U                     /* Samples per second */
+#define MAX_VALUES    16                        /* Values per list option */
+
+#define SIGNAL_TONE   0                         /* Sum of three sines */
+#define SIGNAL_CHIRP  1                         /* Linear sweep, 100 Hz to 3.8 kHz */
+#define SIGNAL_NOISE  2                         /* White noise */
+#define SIGNAL_SPEECH 3                         /* Voiced harmonics, AM at the syllable rate */
+#define SIGNALS       4
+
+/*--------------------------------------------------------------------------
+    Local variables
+ --------------------------------------------------------------------------*/
+
+static const char *signalNames[SIGNALS] = { "tone", "chirp", "noise", "speech" };
+
+/*--------------------------------------------------------------------------
+    Error
+
+    Description:
+        Displays an error message containing the given formatted
+        string.
+ --------------------------------------------------------------------------*/
+
+void Error(const char *fmt, ...)
+{
+    char buff[256];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(buff, sizeof(buff), fmt, args);
+    va_end(args);
+
+    fprintf(stderr, "\nERROR: %s\n", buff);
+    exit(1);
+}
+
+/*--------------------------------------------------------------------------
+    Now
+
+    Description:
+        Returns a monotonic time stamp in seconds.
+ --------------------------------------------------------------------------*/
+
+double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*--------------------------------------------------------------------------
+    Random
+
+    Description:
+        Returns the next value of a linear congruential generator,
+        uniform in [-1, 1). The sequence depends only on the seed, so
+        the signals are the same on every run and every platform.
+ --------------------------------------------------------------------------*/
+
+double Random(uint32_t *seed)
+{
+    *seed = *seed * 1664525U + 1013904223U;
+
+    return (double) (*seed >> 8) / (double) (1U << 23) - 1.0;
+}
+
+/*--------------------------------------------------------------------------
+    Generate
+
+    Description:
+        Generates a synthetic signal.
+
+    Parameters:
+        signal - SIGNAL_xxx
+        x - Generated samples
+        xSize - Number of samples
+ --------------------------------------------------------------------------*/
+
+void Generate(int signal, int16_t x[], uint32_t xSize)
+{
+    uint32_t seed = 1, i;
+    double   t, v, phase = 0.0, f0, env, f;
+    int      h;
+
+    for (i = 0; i < xSize; i++) {
+        t = (double) i / SAMPLE_RATE;
+
+        switch (signal) {
+        case SIGNAL_TONE:
+            v = 6000.0 * sin(2 * M_PI * 220.0 * t) + 3000.0 * sin(2 * M_PI * 660.0 * t) +
+                1500.0 * sin(2 * M_PI * 1320.0 * t);
+            break;
+
+        case SIGNAL_CHIRP:
+            /*
+             * 10 s sweeps; the phase is accumulated to stay continuous.
+             */
+            f = 100.0 + (3800.0 - 100.0) * fmod(t, 10.0) / 10.0;
+            phase = fmod(phase + 2 * M_PI * f / SAMPLE_RATE, 2 * M_PI);
+            v = 12000.0 * sin(phase);
+            break;
+
+        case SIGNAL_NOISE:
+            v = 4000.0 * (Random(&seed) + Random(&seed) + Random(&seed) + Random(&seed));
+            break;
+
+        default:
+            /*
+             * A glottal-like harmonic series with a wandering pitch,
+             * modulated at about 4 syllables per second, with a pause
+             * every 5 seconds and a little breath noise.
+             */
+            f0 = 140.0 + 40.0 * sin(2 * M_PI * 0.3 * t);
+            phase = fmod(phase + 2 * M_PI * f0 / SAMPLE_RATE, 2 * M_PI);
+            for (v = 0.0, h = 1; h <= 10; h++) {
+                v += sin(h * phase) / h;
+            }
+            env = 0.5 - 0.5 * cos(2 * M_PI * 4.0 * t);
+            if (fmod(t, 5.0) >= 4.5) {
+                env = 0.0;
+            }
+            v = 7000.0 * env * v + 200.0 * Random(&seed);
+            break;
+        }
+
+        x[i] = (int16_t) ((v > 32767.0) ? 32767 : (v < -32768.0) ? -32768 : v);
+    }
+}
+
+/*--------------------------------------------------------------------------
+    ParseList
+
+    Description:
+        Parses a comma-separated list of numbers.
+
+    Return Value:
+        Number of values.
+ --------------------------------------------------------------------------*/
+
+int ParseList(const char *option, const char *list, double values[])
+{
+    char *end;
+    int  count = 0;
+
+    for (;;) {
+        if (count == MAX_VALUES) {
+            Error("--%s has more than %d values", option, MAX_VALUES);
+        }
+        values[count++] = strtod(list, &end);
+        if ((end == list) || ((',' != *end) && ('\0' != *end))) {
+            Error("--%s must be a comma-separated list of numbers", option);
+        }
+        if ('\0' == *end) {
+            break;
+        }
+        list = end + 1;
+    }
+
+    return count;
+}
+
+/*--------------------------------------------------------------------------
+    Report
+
+    Description:
+        Prints one result line (tab-separated).
+ --------------------------------------------------------------------------*/
+
+void Report(const char *signal, double seconds, int frameSize, double alpha, const char *stage, uint64_t samples, double elapsed)
+{
+    printf("%s\t%.0f\t%d\t%.2f\t%s\t%" PRIu64 "\t%.6f\t%.3f\t%.0f\n", signal, seconds, frameSize, alpha, stage,
+           samples, elapsed, elapsed * 1e9 / samples, samples / elapsed);
+    fflush(stdout);
+}
+
+/*--------------------------------------------------------------------------
+    Usage
+
+    Description:
+        Displays a help screen for the program.
+ --------------------------------------------------------------------------*/
+
+void Usage(void)
+{
+    printf("Usage: solabench [options]\n");
+    printf("  --signals    Signals among tone, chirp, noise and speech {default = all}\n");
+    printf("  --seconds    Lengths of the signals {default = 10,60}\n");
+    printf("  --framesizes Frame sizes {default = 25,160,400,1000}\n");
+    printf("  --alphas     Time-scale factors {default = 0.5,0.8,1.0,1.3,2.0}\n");
+    printf("  --repeat     Runs per measure, the fastest is kept {default = 3}\n");
+    printf("Prints one tab-separated line per measure:\n");
+    printf("  signal seconds framesize alpha stage samples elapsed ns_per_sample samples_per_sec\n");
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    static struct option options[] = {
+        { "signals",    required_argument, NULL, 's' },
+        { "seconds",    required_argument, NULL, 'l' },
+        { "framesizes", required_argument, NULL, 'n' },
+        { "alphas",     required_argument, NULL, 'a' },
+        { "repeat",     required_argument, NULL, 'r' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL,         0,                 NULL, 0   }
+    };
+
+    double     lengths[MAX_VALUES] = { 10, 60 };
+    double     frameSizes[MAX_VALUES] = { 25, 160, 400, 1000 };
+    double     alphas[MAX_VALUES] = { 0.5, 0.8, 1.0, 1.3, 2.0 };
+    int        lengthCount = 2, frameSizeCount = 4, alphaCount = 5;
+    int        signals[SIGNALS] = { 1, 1, 1, 1 };
+    int        repeat = 3;
+    char       path[] = "/tmp/solabenchXXXXXX";
+    char       *name;
+    FILE       *stream;
+    sola_ctx_t *ctx;
+    int16_t    *x, *y, *input;
+    uint32_t   xSize, inputSize, sampleRate;
+    uint64_t   ySize, yCapacity;
+    double     t, best;
+    int        opt, fd, s, l, n, a, r;
+
+    while (-1 != (opt = getopt_long(argc, argv, "", options, NULL))) {
+        switch (opt) {
+        case 's':
+            memset(signals, 0, sizeof(signals));
+            for (name = strtok(optarg, ","); NULL != name; name = strtok(NULL, ",")) {
+                for (s = 0; (s < SIGNALS) && (0 != strcmp(name, signalNames[s])); s++)
+                    ;
+                if (SIGNALS == s) {
+                    Error("Unknown signal %s", name);
+                }
+                signals[s] = 1;
+            }
+            break;
+
+        case 'l':
+            lengthCount = ParseList("seconds", optarg, lengths);
+            break;
+
+        case 'n':
+            frameSizeCount = ParseList("framesizes", optarg, frameSizes);
+            break;
+
+        case 'a':
+            alphaCount = ParseList("alphas", optarg, alphas);
+            break;
+
+        case 'r':
+            if ((repeat = atoi(optarg)) < 1) {
+                Error("--repeat must be at least 1");
+            }
+            break;
+
+        default:
+            Usage();
+            return ('h' == opt) ? 0 : 1;
+        }
+    }
+
+    if (-1 == (fd = mkstemp(path))) {
+        Error("Can't create a temporary file");
+    }
+    close(fd);
+
+    if (0 != SOLA_CtxCreate(&ctx)) {
+        Error("Not enough memory");
+    }
+
+    printf("signal\tseconds\tframesize\talpha\tstage\tsamples\telapsed\tns_per_sample\tsamples_per_sec\n");
+
+    for (s = 0; s < SIGNALS; s++) {
+        if (!signals[s]) {
+            continue;
+        }
+
+        for (l = 0; l < lengthCount; l++) {
+            if ((lengths[l] <= 0) || ((lengths[l] * SAMPLE_RATE) > UINT32_MAX)) {
+                Error("Invalid length %g", lengths[l]);
+            }
+            xSize = (uint32_t) (lengths[l] * SAMPLE_RATE);
+
+            if (NULL == (x = (int16_t *) malloc(((size_t) xSize + 1) * sizeof(int16_t)))) {
+                Error("Not enough memory");
+            }
+            Generate(s, x, xSize);
+
+            /*
+             * Read: the generated signal is saved once, then read back.
+             * The TSM works on the decoded signal, as the codec would
+             * give it.
+             */
+            if ((NULL == (stream = fopen(path, "wb"))) || (0 != ULAW_SaveFile(stream, x, xSize, SAMPLE_RATE)) ||
+                (0 != fclose(stream))) {
+                Error("Problem writing %s", path);
+            }
+
+            /*
+             * The buffers are reused from run to run, as a service
+             * processing many files would, so that only the work on
+             * the samples is timed.
+             */
+            input = x;
+            for (best = 0.0, r = 0; r < repeat; r++) {
+                if (NULL == (stream = fopen(path, "rb"))) {
+                    Error("Can't open %s", path);
+                }
+                t = Now();
+                if (0 != ULAW_ReadFileInto(1, stream, input, xSize, &inputSize, &sampleRate)) {
+                    Error("Problem reading %s", path);
+                }
+                t = Now() - t;
+                fclose(stream);
+                if ((0 == r) || (t < best)) best = t;
+            }
+            Report(signalNames[s], lengths[l], 0, 0.0, "read", inputSize, best);
+
+            for (n = 0; n < frameSizeCount; n++) {
+                if (0 != SOLA_CtxSetFrameSize(ctx, (uint16_t) frameSizes[n])) {
+                    Error("Invalid frame size %g", frameSizes[n]);
+                }
+
+                for (a = 0; a < alphaCount; a++) {
+                    /*
+                     * TSM.
+                     */
+                    yCapacity = SOLA_CtxGetOutputSize(ctx, inputSize, (float) alphas[a]);
+                    if ((0 == yCapacity) || (NULL == (y = (int16_t *) malloc((size_t) yCapacity * sizeof(int16_t))))) {
+                        Error("TSM failed (framesize %g, alpha %g)", frameSizes[n], alphas[a]);
+                    }
+                    for (best = 0.0, r = 0; r < repeat; r++) {
+                        t = Now();
+                        if (0 != SOLA_CtxProcessInto(ctx, input, inputSize, y, yCapacity, &ySize, (float) alphas[a])) {
+                            Error("TSM failed (framesize %g, alpha %g)", frameSizes[n], alphas[a]);
+                        }
+                        t = Now() - t;
+                        if ((0 == r) || (t < best)) best = t;
+                    }
+                    Report(signalNames[s], lengths[l], (int) frameSizes[n], alphas[a], "tsm", inputSize, best);
+
+                    /*
+                     * Write (per output sample).
+                     */
+                    for (best = 0.0, r = 0; r < repeat; r++) {
+                        if (NULL == (stream = fopen(path, "wb"))) {
+                            Error("Can't open %s", path);
+                        }
+                        t = Now();
+                        if ((0 != ULAW_SaveFile(stream, y, (uint32_t) ySize, SAMPLE_RATE)) || (0 != fflush(stream))) {
+                            Error("Problem writing %s", path);
+                        }
+                        t = Now() - t;
+                        fclose(stream);
+                        if ((0 == r) || (t < best)) best = t;
+                    }
+                    Report(signalNames[s], lengths[l], (int) frameSizes[n], alphas[a], "write", ySize, best);
+                    free(y);
+                }
+            }
+
+            free(input);
+        }
+    }
+
+    SOLA_CtxDestroy(ctx);
+    unlink(path);
+
+    return 0;
+}
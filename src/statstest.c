@@ -0,0 +1,97 @@
+/*--------------------------------------------------------------------------
+    FILE                :   statstest.c
+
+    PURPOSE             :   Test of the counters of the SOLA statistics on
+                            a corpus file: frames, lag evaluations, lag
+                            histogram, searches cut short by the
+                            L < N/8 restriction, and silent frames, as
+                            also given by SOLA_CtxGetFrameCounts
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "typedef.h"
+#include "ulawapi.h"
+#include "solaapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define CORPUS  "../audio/apu.au"
+#define SILENCE 200                             /* Level of the silent frames of the corpus */
+
+/*--------------------------------------------------------------------------
+    Fail
+
+    Description:
+        Displays a failure and exits.
+ --------------------------------------------------------------------------*/
+
+void Fail(const char *what, float alpha)
+{
+    fprintf(stderr, "statstest: FAILED: %s (alpha %g)\n", what, alpha);
+    exit(1);
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(void)
+{
+    static const float alphas[] = { 0.5f, 0.8f, 1.5f, 2.0f };
+    sola_ctx_t   *ctx;
+    sola_stats_t stats;
+    FILE         *stream;
+    int16_t      *x, *y;
+    uint64_t     ySize, total, frames, silentFrames;
+    uint32_t     xSize, sampleRate;
+    size_t       a;
+    int          i;
+
+    if ((NULL == (stream = fopen(CORPUS, "rb"))) || (0 != ULAW_ReadFile(1, stream, &x, &xSize, &sampleRate))) {
+        Fail("cannot read " CORPUS, 0.0f);
+    }
+    fclose(stream);
+
+    for (a = 0; a < sizeof(alphas) / sizeof(alphas[0]); a++) {
+        if ((0 != SOLA_CtxCreate(&ctx)) || (0 != SOLA_CtxSetSearchMethod(ctx, SOLA_SEARCH_DIRECT)) ||
+            (0 != SOLA_CtxSetSilenceThreshold(ctx, SILENCE))) {
+            Fail("context", alphas[a]);
+        }
+        memset(&stats, 0, sizeof(stats));
+        SOLA_CtxSetStats(ctx, &stats);
+        if (0 != SOLA_CtxProcess(ctx, x, xSize, &y, &ySize, alphas[a])) {
+            Fail("SOLA_CtxProcess", alphas[a]);
+        }
+        SOLA_CtxGetFrameCounts(ctx, &frames, &silentFrames);
+        SOLA_CtxDestroy(ctx);
+        free(y);
+
+        for (total = 0, i = 0; i < SOLA_KM_BINS; i++) {
+            total += stats.kmHistogram[i];
+        }
+        if ((0 == stats.frames) || (0 == stats.lagEvaluations) || (total > stats.frames)) {
+            Fail("frame counters", alphas[a]);
+        }
+        if ((0 == stats.earlyExits) || (stats.earlyExits > stats.frames)) {
+            Fail("no search cut short by L < N/8", alphas[a]);
+        }
+        if ((0 == stats.silentFrames) || (frames != stats.frames) || (silentFrames != stats.silentFrames)) {
+            Fail("silent frames", alphas[a]);
+        }
+    }
+
+    free(x);
+    printf("statstest: counters on " CORPUS ": OK\n");
+
+    return 0;
+}
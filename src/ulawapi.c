@@ -12,6 +12,13 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "typedef.h"
 #include "ulawapi.h"
 
@@ -19,6 +26,490 @@
     ===> PRIVATE <===
  --------------------------------------------------------------------------*/
 
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define ULAW_BLOCK_SIZE 65536U                  /* Size of the I/O blocks (bytes) */
+#define ULAW_SYNC_SIZE  (8U << 20)              /* Bytes synced before ULAW_WRITE_DONTNEED */
+
+#define WAV_FORMAT_PCM        0x0001            /* Format tags of RIFF/WAV */
+#define WAV_FORMAT_ALAW       0x0006
+#define WAV_FORMAT_MULAW      0x0007
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+/*
+ * Container whose 16-bit samples are in the byte order of the host,
+ * so that they are copied without conversion.
+ */
+#ifdef LITTLE_ENDIAN
+#define NATIVE_CONTAINER ULAW_CONTAINER_WAV
+#else
+#define NATIVE_CONTAINER ULAW_CONTAINER_AU
+#endif
+
+/*--------------------------------------------------------------------------
+    General constants and data types
+ --------------------------------------------------------------------------*/
+
+struct ulaw_map {
+    uint8_t             *base;                  /* Mapping of the whole file */
+    size_t              length;                 /* Size of the mapping */
+    uint8_t             *data;                  /* Audio data (in the mapping) */
+    uint32_t            frames;                 /* Samples per channel */
+    audio_file_header_t header;                 /* Header (host byte order) */
+    int                 container;              /* ULAW_CONTAINER_xxx */
+    ulaw_stats_t        *stats;                 /* Statistics of ULAW_DecodeMap */
+};
+
+/*--------------------------------------------------------------------------
+    Local variables
+ --------------------------------------------------------------------------*/
+
+/*
+ * ulaw to linear lookup table, i.e. ULAW2Linear(i) for i < 256.
+ */
+static const int16_t decodeTable[256] = {
+    -32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+    -23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+    -15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+    -11900, -11388, -10876, -10364,  -9852,  -9340,  -8828,  -8316,
+     -7932,  -7676,  -7420,  -7164,  -6908,  -6652,  -6396,  -6140,
+     -5884,  -5628,  -5372,  -5116,  -4860,  -4604,  -4348,  -4092,
+     -3900,  -3772,  -3644,  -3516,  -3388,  -3260,  -3132,  -3004,
+     -2876,  -2748,  -2620,  -2492,  -2364,  -2236,  -2108,  -1980,
+     -1884,  -1820,  -1756,  -1692,  -1628,  -1564,  -1500,  -1436,
+     -1372,  -1308,  -1244,  -1180,  -1116,  -1052,   -988,   -924,
+      -876,   -844,   -812,   -780,   -748,   -716,   -684,   -652,
+      -620,   -588,   -556,   -524,   -492,   -460,   -428,   -396,
+      -372,   -356,   -340,   -324,   -308,   -292,   -276,   -260,
+      -244,   -228,   -212,   -196,   -180,   -164,   -148,   -132,
+      -120,   -112,   -104,    -96,    -88,    -80,    -72,    -64,
+       -56,    -48,    -40,    -32,    -24,    -16,     -8,      0,
+     32124,  31100,  30076,  29052,  28028,  27004,  25980,  24956,
+     23932,  22908,  21884,  20860,  19836,  18812,  17788,  16764,
+     15996,  15484,  14972,  14460,  13948,  13436,  12924,  12412,
+     11900,  11388,  10876,  10364,   9852,   9340,   8828,   8316,
+      7932,   7676,   7420,   7164,   6908,   6652,   6396,   6140,
+      5884,   5628,   5372,   5116,   4860,   4604,   4348,   4092,
+      3900,   3772,   3644,   3516,   3388,   3260,   3132,   3004,
+      2876,   2748,   2620,   2492,   2364,   2236,   2108,   1980,
+      1884,   1820,   1756,   1692,   1628,   1564,   1500,   1436,
+      1372,   1308,   1244,   1180,   1116,   1052,    988,    924,
+       876,    844,    812,    780,    748,    716,    684,    652,
+       620,    588,    556,    524,    492,    460,    428,    396,
+       372,    356,    340,    324,    308,    292,    276,    260,
+       244,    228,    212,    196,    180,    164,    148,    132,
+       120,    112,    104,     96,     88,     80,     72,     64,
+        56,     48,     40,     32,     24,     16,      8,      0
+};
+
+/*
+ * Linear to ulaw lookup table, indexed by the sign and the magnitude
+ * of the sample divided by 4 (see ULAW_EncodeBlock). The index is
+ * computed without a branch since the sign of audio is unpredictable.
+ */
+#define ENCODE_SIGN(sample)  ((int32_t) (sample) >> 15)
+#define ENCODE_INDEX(sample) (((((int32_t) (sample) ^ ENCODE_SIGN(sample)) - ENCODE_SIGN(sample)) >> 2) + (ENCODE_SIGN(sample) & 8193))
+
+static uint8_t        encodeTable[2 * 8193];
+static pthread_once_t encodeTableOnce = PTHREAD_ONCE_INIT;
+
+/*
+ * A-law to linear lookup table, i.e. ALAW2Linear(i) for i < 256.
+ */
+static const int16_t alawDecodeTable[256] = {
+     -5504,  -5248,  -6016,  -5760,  -4480,  -4224,  -4992,  -4736,
+     -7552,  -7296,  -8064,  -7808,  -6528,  -6272,  -7040,  -6784,
+     -2752,  -2624,  -3008,  -2880,  -2240,  -2112,  -2496,  -2368,
+     -3776,  -3648,  -4032,  -3904,  -3264,  -3136,  -3520,  -3392,
+    -22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+    -30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+    -11008, -10496, -12032, -11520,  -8960,  -8448,  -9984,  -9472,
+    -15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+      -344,   -328,   -376,   -360,   -280,   -264,   -312,   -296,
+      -472,   -456,   -504,   -488,   -408,   -392,   -440,   -424,
+       -88,    -72,   -120,   -104,    -24,     -8,    -56,    -40,
+      -216,   -200,   -248,   -232,   -152,   -136,   -184,   -168,
+     -1376,  -1312,  -1504,  -1440,  -1120,  -1056,  -1248,  -1184,
+     -1888,  -1824,  -2016,  -1952,  -1632,  -1568,  -1760,  -1696,
+      -688,   -656,   -752,   -720,   -560,   -528,   -624,   -592,
+      -944,   -912,  -1008,   -976,   -816,   -784,   -880,   -848,
+      5504,   5248,   6016,   5760,   4480,   4224,   4992,   4736,
+      7552,   7296,   8064,   7808,   6528,   6272,   7040,   6784,
+      2752,   2624,   3008,   2880,   2240,   2112,   2496,   2368,
+      3776,   3648,   4032,   3904,   3264,   3136,   3520,   3392,
+     22016,  20992,  24064,  23040,  17920,  16896,  19968,  18944,
+     30208,  29184,  32256,  31232,  26112,  25088,  28160,  27136,
+     11008,  10496,  12032,  11520,   8960,   8448,   9984,   9472,
+     15104,  14592,  16128,  15616,  13056,  12544,  14080,  13568,
+       344,    328,    376,    360,    280,    264,    312,    296,
+       472,    456,    504,    488,    408,    392,    440,    424,
+        88,     72,    120,    104,     24,      8,     56,     40,
+       216,    200,    248,    232,    152,    136,    184,    168,
+      1376,   1312,   1504,   1440,   1120,   1056,   1248,   1184,
+      1888,   1824,   2016,   1952,   1632,   1568,   1760,   1696,
+       688,    656,    752,    720,    560,    528,    624,    592,
+       944,    912,   1008,    976,    816,    784,    880,    848
+};
+
+/*
+ * Linear to A-law lookup table. The A-law code only depends on the
+ * sample shifted right by 3, so the 13 upper bits of the sample index
+ * the table (see InitEncodeTable).
+ */
+#define ALAW_INDEX(sample) ((uint16_t) (sample) >> 3)
+
+static uint8_t        alawEncodeTable[8192];
+
+/*
+ * Statistics of the I/O functions called by this thread (see
+ * ULAW_SetStats).
+ */
+static __thread ulaw_stats_t *threadStats = NULL;
+
+/*--------------------------------------------------------------------------
+    InitEncodeTable
+
+    Description:
+        Fills the linear to ulaw lookup table. The ulaw code only
+        depends on (magnitude + BIAS) >> 3 and larger shifts, and BIAS
+        is a multiple of 4, so all the magnitudes with the same
+        quotient by 4 share one entry. Negative index 8192 is -32768
+        alone.
+ --------------------------------------------------------------------------*/
+
+static void InitEncodeTable(void)
+{
+    int32_t i;
+
+    for (i = 0; i <= 8192; i++) {
+        encodeTable[i] = Linear2ULAW((int16_t) ((i < 8192) ? (i << 2) : 32767));
+        encodeTable[8193 + i] = Linear2ULAW((int16_t) -((i > 0) ? (i << 2) : 1));
+    }
+
+    for (i = 0; i < 8192; i++) {
+        alawEncodeTable[i] = Linear2ALAW((int16_t) (uint16_t) (i << 3));
+    }
+}
+
+/*--------------------------------------------------------------------------
+    ReadClock
+
+    Description:
+        Reads the monotonic clock and the CPU time of the calling
+        thread (ns).
+ --------------------------------------------------------------------------*/
+
+static void ReadClock(uint64_t *wall, uint64_t *cpu)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *wall = (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    *cpu = (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+}
+
+/*--------------------------------------------------------------------------
+    AddStats
+
+    Description:
+        Adds a number of bytes and the time elapsed since a reading of
+        ReadClock to the read or write counters of some statistics.
+        The counters are updated atomically, since a map may be
+        decoded from several threads at once.
+ --------------------------------------------------------------------------*/
+
+static void AddStats(ulaw_stats_t *stats, int write, uint64_t bytes, uint64_t wall, uint64_t cpu)
+{
+    uint64_t now, nowCpu;
+
+    ReadClock(&now, &nowCpu);
+
+    if (write) {
+        __atomic_add_fetch(&stats->bytesWritten, bytes, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stats->writeWallTime, now - wall, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stats->writeCpuTime, nowCpu - cpu, __ATOMIC_RELAXED);
+    } else {
+        __atomic_add_fetch(&stats->bytesRead, bytes, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stats->readWallTime, now - wall, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&stats->readCpuTime, nowCpu - cpu, __ATOMIC_RELAXED);
+    }
+}
+
+#ifdef LITTLE_ENDIAN
+/*--------------------------------------------------------------------------
+    ByteSwapHeader
+ --------------------------------------------------------------------------*/
+
+static void ByteSwapHeader(audio_file_header_t *header)
+{
+    header->magic = SWAPU32(header->magic);
+    header->dataLocation = SWAPU32(header->dataLocation);
+    header->dataSize = SWAPU32(header->dataSize);
+    header->dataFormat = SWAPU32(header->dataFormat);
+    header->sampleRate = SWAPU32(header->sampleRate);
+    header->channels = SWAPU32(header->channels);
+    header->info = SWAPU32(header->info);
+}
+#endif
+
+/*--------------------------------------------------------------------------
+    GetU16LE, GetU32LE, PutU16LE & PutU32LE
+
+    Description:
+        Read and write the little-endian fields of a RIFF/WAV header.
+ --------------------------------------------------------------------------*/
+
+static uint16_t GetU16LE(const uint8_t *p)
+{
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t GetU32LE(const uint8_t *p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void PutU16LE(uint8_t *p, uint16_t value)
+{
+    p[0] = LOU8(value);
+    p[1] = HIU8(value);
+}
+
+static void PutU32LE(uint8_t *p, uint32_t value)
+{
+    PutU16LE(p, LOU16(value));
+    PutU16LE(p + 2, HIU16(value));
+}
+
+/*--------------------------------------------------------------------------
+    ParseHeader
+
+    Description:
+        Parses the header of a .au or RIFF/WAV file from its first
+        bytes. The header is returned as a .au header in host byte
+        order, whatever the container: dataFormat is a
+        ULAW_FORMAT_xxx and dataSize is in bytes. The chunks of a
+        RIFF/WAV file are searched up to the "data" chunk, which must
+        start within the given bytes.
+
+    Parameters:
+        bytes - First bytes of the file
+        length - Number of bytes
+        header - Header of the file (pointer)
+        container - ULAW_CONTAINER_xxx (pointer)
+
+    Return Value:
+        0 on success; otherwise EINVAL if the file is not a supported
+        audio file.
+ --------------------------------------------------------------------------*/
+
+static int ParseHeader(const uint8_t *bytes, size_t length, audio_file_header_t *header, int *container)
+{
+    size_t   offset, size;
+    uint32_t tag = 0, bits = 0;
+
+    memset(header, 0, sizeof(audio_file_header_t));
+
+    if ((length >= 12) && (0 == memcmp(bytes, "RIFF", 4)) && (0 == memcmp(&bytes[8], "WAVE", 4))) {
+        *container = ULAW_CONTAINER_WAV;
+
+        /*
+         * The "fmt " chunk must precede the "data" chunk. Chunks are
+         * padded to an even size.
+         */
+        for (offset = 12; (offset + 8) <= length; offset += 8 + size + (size & 1)) {
+            size = GetU32LE(&bytes[offset + 4]);
+            if ((0 == memcmp(&bytes[offset], "fmt ", 4)) && (size >= 16) && ((offset + 8 + 16) <= length)) {
+                tag = GetU16LE(&bytes[offset + 8]);
+                header->channels = GetU16LE(&bytes[offset + 10]);
+                header->sampleRate = GetU32LE(&bytes[offset + 12]);
+                bits = GetU16LE(&bytes[offset + 22]);
+                if ((WAV_FORMAT_EXTENSIBLE == tag) && (size >= 40) && ((offset + 8 + 40) <= length)) {
+                    tag = GetU16LE(&bytes[offset + 8 + 24]);  /* First bytes of the sub-format GUID */
+                }
+            } else if (0 == memcmp(&bytes[offset], "data", 4)) {
+                header->dataLocation = (uint32_t) (offset + 8);
+                header->dataSize = (uint32_t) size;
+                break;
+            }
+        }
+
+        if ((WAV_FORMAT_PCM == tag) && (16 == bits)) {
+            header->dataFormat = ULAW_FORMAT_PCM16;
+        } else if ((WAV_FORMAT_ALAW == tag) && (8 == bits)) {
+            header->dataFormat = ULAW_FORMAT_ALAW;
+        } else if ((WAV_FORMAT_MULAW == tag) && (8 == bits)) {
+            header->dataFormat = ULAW_FORMAT_MULAW;
+        } else {
+            return EINVAL;
+        }
+
+        if (0 == header->dataLocation) {
+            return EINVAL;
+        }
+    } else {
+        *container = ULAW_CONTAINER_AU;
+
+        if (length < sizeof(audio_file_header_t)) {
+            return EINVAL;
+        }
+
+        memcpy(header, bytes, sizeof(audio_file_header_t));
+
+#ifdef LITTLE_ENDIAN
+        ByteSwapHeader(header);
+#endif
+
+        if (AUDIO_FILE_MAGIC_NUMBER != header->magic)
+            return EINVAL;
+        if ((ULAW_FORMAT_MULAW != header->dataFormat) && (ULAW_FORMAT_PCM16 != header->dataFormat) && (ULAW_FORMAT_ALAW != header->dataFormat))
+            return EINVAL;
+    }
+
+    if (0 == header->channels) {
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    DecodeSamples
+
+    Description:
+        Converts samples of one channel to linear. Samples in 16-bit
+        linear PCM of the byte order of the host are copied as is,
+        with a single copy when they are contiguous.
+
+    Parameters:
+        data - First sample
+        stride - Bytes from a sample to the next one
+        count - Number of samples
+        format - ULAW_FORMAT_xxx
+        container - ULAW_CONTAINER_xxx (byte order of 16-bit samples)
+        linear - Decoded samples
+ --------------------------------------------------------------------------*/
+
+static void DecodeSamples(const uint8_t *data, size_t stride, uint32_t count, uint32_t format, int container, int16_t linear[])
+{
+    uint32_t i;
+
+    if (ULAW_FORMAT_MULAW == format) {
+        for (i = 0; i < count; i++) {
+            linear[i] = decodeTable[data[(size_t) i * stride]];
+        }
+    } else if (ULAW_FORMAT_ALAW == format) {
+        for (i = 0; i < count; i++) {
+            linear[i] = alawDecodeTable[data[(size_t) i * stride]];
+        }
+    } else if (NATIVE_CONTAINER == container) {
+        if (sizeof(int16_t) == stride) {
+            memcpy(linear, data, (size_t) count * sizeof(int16_t));
+        } else {
+            for (i = 0; i < count; i++) {
+                memcpy(&linear[i], &data[(size_t) i * stride], sizeof(int16_t));
+            }
+        }
+    } else if (ULAW_CONTAINER_WAV == container) {
+        for (i = 0; i < count; i++) {
+            linear[i] = (int16_t) GetU16LE(&data[(size_t) i * stride]);
+        }
+    } else {
+        for (i = 0; i < count; i++) {
+            linear[i] = (int16_t) ((data[(size_t) i * stride] << 8) | data[(size_t) i * stride + 1]);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------
+    EncodeSamples
+
+    Description:
+        Converts linear samples of one channel to a format, the
+        converse of DecodeSamples.
+ --------------------------------------------------------------------------*/
+
+static void EncodeSamples(const int16_t linear[], uint32_t count, uint32_t format, int container, uint8_t *data, size_t stride)
+{
+    uint32_t i;
+
+    if (ULAW_FORMAT_MULAW == format) {
+        for (i = 0; i < count; i++) {
+            data[(size_t) i * stride] = encodeTable[ENCODE_INDEX(linear[i])];
+        }
+    } else if (ULAW_FORMAT_ALAW == format) {
+        for (i = 0; i < count; i++) {
+            data[(size_t) i * stride] = alawEncodeTable[ALAW_INDEX(linear[i])];
+        }
+    } else if (NATIVE_CONTAINER == container) {
+        for (i = 0; i < count; i++) {
+            memcpy(&data[(size_t) i * stride], &linear[i], sizeof(int16_t));
+        }
+    } else if (ULAW_CONTAINER_WAV == container) {
+        for (i = 0; i < count; i++) {
+            PutU16LE(&data[(size_t) i * stride], (uint16_t) linear[i]);
+        }
+    } else {
+        for (i = 0; i < count; i++) {
+            data[(size_t) i * stride] = HIU8(linear[i]);
+            data[(size_t) i * stride + 1] = LOU8(linear[i]);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------
+    MakeWavHeader
+
+    Description:
+        Builds the header of a RIFF/WAV file (WAV_FILE_HEADER_SIZE
+        bytes).
+ --------------------------------------------------------------------------*/
+
+static void MakeWavHeader(uint8_t header[], uint32_t format, uint16_t channels, uint32_t sampleRate, uint32_t dataSize)
+{
+    uint16_t blockAlign = (uint16_t) (channels * ULAW_SAMPLE_SIZE(format));
+
+    memcpy(&header[0], "RIFF", 4);
+    PutU32LE(&header[4], WAV_FILE_HEADER_SIZE - 8 + dataSize);
+    memcpy(&header[8], "WAVE", 4);
+    memcpy(&header[12], "fmt ", 4);
+    PutU32LE(&header[16], 16);
+    PutU16LE(&header[20], (ULAW_FORMAT_PCM16 == format) ? WAV_FORMAT_PCM :
+                          (ULAW_FORMAT_ALAW == format) ? WAV_FORMAT_ALAW : WAV_FORMAT_MULAW);
+    PutU16LE(&header[22], channels);
+    PutU32LE(&header[24], sampleRate);
+    PutU32LE(&header[28], sampleRate * blockAlign);
+    PutU16LE(&header[32], blockAlign);
+    PutU16LE(&header[34], (uint16_t) (8 * ULAW_SAMPLE_SIZE(format)));
+    memcpy(&header[36], "data", 4);
+    PutU32LE(&header[40], dataSize);
+}
+
+/*--------------------------------------------------------------------------
+    ===> PUBLIC <===
+ --------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------
+    ULAW_SetStats
+
+    Description:
+        Collects the statistics of the file functions (ULAW_ReadFile,
+        ULAW_SaveFile, ULAW_SaveFileEx, ULAW_SaveChannels and
+        ULAW_MapFile) called by this thread into stats, which the
+        caller should clear first. A map keeps the statistics set when
+        it was created, so that ULAW_DecodeMap adds to them from any
+        thread. NULL stops the collection (default).
+ --------------------------------------------------------------------------*/
+
+void ULAW_SetStats(ulaw_stats_t *stats)
+{
+    threadStats = stats;
+}
+
 /*--------------------------------------------------------------------------
     ULAW2Linear
 
@@ -26,7 +517,7 @@
         This routine converts from ulaw to linear.
  --------------------------------------------------------------------------*/
 
-static int16_t ULAW2Linear(uint8_t ulaw)
+int16_t ULAW2Linear(uint8_t ulaw)
 {
     static int exp_lut[8] = { 0,132,396,924,1980,4092,8316,16764 };
     int16_t    sign, exponent, mantissa, sample;
@@ -68,7 +559,7 @@ static int16_t ULAW2Linear(uint8_t ulaw)
 #define BIAS        0x84    /* Define the add-in bias for 16 bit samples */
 #define CLIP        32635
 
-static uint8_t Linear2ULAW(int16_t sample)
+uint8_t Linear2ULAW(int16_t sample)
 {
     static int16_t exp_lut[256] = { 0,0,1,1,2,2,2,2,3,3,3,3,3,3,3,3,
                                     4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
@@ -114,88 +605,231 @@ static uint8_t Linear2ULAW(int16_t sample)
     return ulaw;
 }
 
-#ifdef LITTLE_ENDIAN
 /*--------------------------------------------------------------------------
-    ByteSwapHeader
+    ALAW2Linear
+
+    Description:
+        This routine converts from A-law to linear.
  --------------------------------------------------------------------------*/
 
-static void ByteSwapHeader(audio_file_header_t *header)
+int16_t ALAW2Linear(uint8_t alaw)
 {
-    header->magic = SWAPU32(header->magic);
-    header->dataLocation = SWAPU32(header->dataLocation);
-    header->dataSize = SWAPU32(header->dataSize);
-    header->dataFormat = SWAPU32(header->dataFormat);
-    header->sampleRate = SWAPU32(header->sampleRate);
-    header->channels = SWAPU32(header->channels);
-    header->info = SWAPU32(header->info);
+    int16_t sample, segment;
+
+    alaw ^= 0x55;
+    sample = (alaw & 0x0F) << 4;
+    segment = (alaw & 0x70) >> 4;
+    switch (segment) {
+    case 0:
+        sample += 8;
+        break;
+    case 1:
+        sample += 0x108;
+        break;
+    default:
+        sample += 0x108;
+        sample <<= segment - 1;
+    }
+    return (alaw & 0x80) ? sample : -sample;
 }
-#endif
 
 /*--------------------------------------------------------------------------
-    ===> PUBLIC <===
+    Linear2ALAW
+
+    Description:
+        This routine converts from linear to A-law (CCITT G.711), on
+        the 13 upper bits of the sample.
+
+    Input: Signed 16 bit linear sample
+    Output: 8 bit A-law sample
  --------------------------------------------------------------------------*/
 
+uint8_t Linear2ALAW(int16_t sample)
+{
+    static int16_t seg_end[8] = { 0x1F,0x3F,0x7F,0xFF,0x1FF,0x3FF,0x7FF,0xFFF };
+
+    int16_t segment;
+    uint8_t mask, alaw;
+
+    /*
+     * Get the sample into sign-magnitude.
+     */
+    sample = sample >> 3;
+    if (sample >= 0) {
+        mask = 0xD5;                            /* Sign (7th) bit = 1 */
+    } else {
+        mask = 0x55;                            /* Sign bit = 0 */
+        sample = -sample - 1;
+    }
+
+    /*
+     * Convert the magnitude to the segment number.
+     */
+    for (segment = 0; (segment < 8) && (sample > seg_end[segment]); segment++)
+        ;
+
+    /*
+     * Combine the sign, segment and quantization bits.
+     */
+    if (segment >= 8) {
+        return (uint8_t) (0x7F ^ mask);         /* Out of range, return the maximum */
+    }
+    alaw = (uint8_t) (segment << 4);
+    alaw |= (sample >> ((segment < 2) ? 1 : segment)) & 0x0F;
+
+    return (uint8_t) (alaw ^ mask);
+}
+
 /*--------------------------------------------------------------------------
-    ULAW_ReadFile
+    ReadChannel
 
     Description:
-        Reads ulaw encoded audio file.
+        Reads the samples of one channel of an audio file, into the
+        buffer given, or into a new one if *buffer is NULL (see
+        ULAW_ReadFile and ULAW_ReadFileInto).
+
+    Return Value:
+        0 if successful; ENOSPC if the buffer given is too small, in
+        which case bufferSize receives the size needed and the stream
+        is put back where it was; otherwise an errno value. The stream
+        belongs to the caller and is never closed here.
  --------------------------------------------------------------------------*/
 
-int ULAW_ReadFile(uint16_t channel, FILE *stream, int16_t *buffer[], uint32_t *bufferSize, uint32_t *sampleRate)
+static int ReadChannel(uint16_t channel, FILE *stream, int16_t *buffer[], uint32_t capacity, uint32_t *bufferSize,
+                       uint32_t *sampleRate)
 {
     audio_file_header_t header;
-    uint8_t             sample;
-    uint32_t            i;
+    uint8_t             *block;
+    uint32_t            frames, frameBytes, blockFrames, n;
+    uint32_t            offset = 0;
+    long                start;
+    size_t              length;
+    int                 allocated = (NULL == *buffer);
+    int                 container, err;
+    uint64_t            wall = 0, cpu = 0;
+
+    if (NULL != threadStats) ReadClock(&wall, &cpu);
+
+    if (NULL == (block = (uint8_t *) malloc(ULAW_BLOCK_SIZE))) {
+        return ENOMEM;
+    }
 
     /*
-     * Read the audio file header and check if it's valid.
+     * Read the first block of the file, and parse the audio file
+     * header in it and check if it's valid.
      */
-    if (1 != fread(&header, sizeof(audio_file_header_t), 1, stream)) {
-        return EINVAL;
+    start = ftell(stream);
+    length = fread(block, 1, ULAW_BLOCK_SIZE, stream);
+    if (0 != (err = ParseHeader(block, length, &header, &container))) {
+        free(block);
+        return err;
     }
-
-#ifdef LITTLE_ENDIAN
-    ByteSwapHeader(&header);
-#endif
-
-    if (AUDIO_FILE_MAGIC_NUMBER != header.magic)
-        return EINVAL;
-    if(/* ulaw */ 1 != header.dataFormat)
-        return EINVAL;
-    if (channel > header.channels)
+    if ((0 == channel) || (channel > header.channels)) {
+        free(block);
         return EINVAL;
+    }
 
     *sampleRate = header.sampleRate;
 
     /*
-     * Allocate memory for audio data.
+     * Allocate memory for audio data (unless the caller gave it), one
+     * sample per frame of interleaved channels. The block is reused
+     * for the raw data.
      */
-    *bufferSize = header.dataSize;
-    if (NULL == (*buffer = (int16_t *) malloc(header.dataSize * sizeof(int16_t)))) {
+    frameBytes = header.channels * ULAW_SAMPLE_SIZE(header.dataFormat);
+    frames = header.dataSize / frameBytes;
+    blockFrames = ULAW_BLOCK_SIZE / frameBytes;
+    if (0 == blockFrames) {
+        free(block);
+        return EINVAL;
+    }
+
+    *bufferSize = frames;
+    if (!allocated && (frames > capacity)) {
+        free(block);
+        fseek(stream, start, SEEK_SET);
+        return ENOSPC;
+    }
+    if (allocated && (NULL == (*buffer = (int16_t *) malloc(frames * sizeof(int16_t))))) {
+        free(block);
         return ENOMEM;
     }
 
     /*
-     * Go read the audio file.
+     * Go read the audio file, one block of frames at a time, and
+     * extract and decode the samples of the channel in memory.
      */
     fseek(stream, header.dataLocation, SEEK_SET);
-    fseek(stream, channel - 1, SEEK_CUR);
-    for (i = 0; (i < header.dataSize) && !feof(stream); i++) {
-        if (1 != fread(&sample, sizeof(uint8_t), 1, stream)) {
-            free(*buffer);
-            fclose(stream);
+    while (offset < frames) {
+        n = ((frames - offset) < blockFrames) ? (frames - offset) : blockFrames;
+        if (n != fread(block, frameBytes, n, stream)) {
+            free(block);
+            if (allocated) free(*buffer);
             return EIO;
         }
 
-        (*buffer)[i] = ULAW2Linear(sample);
+        DecodeSamples(&block[(channel - 1) * ULAW_SAMPLE_SIZE(header.dataFormat)], frameBytes, n,
+                      header.dataFormat, container, &(*buffer)[offset]);
 
-        fseek(stream, header.channels - 1, SEEK_CUR);
+        offset += n;
     }
 
+    free(block);
+
+    if (NULL != threadStats) AddStats(threadStats, 0, header.dataLocation + (uint64_t) frames * frameBytes, wall, cpu);
+
     return 0;
 }
 
+/*--------------------------------------------------------------------------
+    ULAW_ReadFile
+
+    Description:
+        Reads an audio file: .au in mu-law, A-law or 16-bit linear
+        PCM, or RIFF/WAV in the same formats (see ParseHeader). The
+        samples of one channel (1 = first) are returned as linear, in
+        memory allocated by the function and freed by the caller.
+ --------------------------------------------------------------------------*/
+
+int ULAW_ReadFile(uint16_t channel, FILE *stream, int16_t *buffer[], uint32_t *bufferSize, uint32_t *sampleRate)
+{
+    *buffer = NULL;
+
+    return ReadChannel(channel, stream, buffer, 0, bufferSize, sampleRate);
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_ReadFileInto
+
+    Description:
+        Reads an audio file like ULAW_ReadFile, into a buffer provided
+        by the caller (e.g. one reused from file to file).
+
+    Parameters:
+        channel    - Channel to read (1 = first)
+        stream     - Input stream
+        buffer     - Buffer for the linear samples
+        capacity   - Number of samples of the buffer
+        bufferSize - Receives the number of samples read
+        sampleRate - Receives the samples per second
+
+    Return Value:
+        0 if successful; ENOSPC if the buffer is too small, in which
+        case bufferSize receives the number of samples of the channel
+        and the stream is put back where it was, so the call can be
+        made again with a larger buffer; otherwise an errno value.
+ --------------------------------------------------------------------------*/
+
+int ULAW_ReadFileInto(uint16_t channel, FILE *stream, int16_t buffer[], uint32_t capacity, uint32_t *bufferSize,
+                      uint32_t *sampleRate)
+{
+    if (NULL == buffer) {
+        return EINVAL;
+    }
+
+    return ReadChannel(channel, stream, &buffer, capacity, bufferSize, sampleRate);
+}
+
 /*--------------------------------------------------------------------------
     ULAW_SaveFile
 
@@ -204,37 +838,482 @@ int ULAW_ReadFile(uint16_t channel, FILE *stream, int16_t *buffer[], uint32_t *b
  --------------------------------------------------------------------------*/
 
 int ULAW_SaveFile(FILE *stream, int16_t buffer[], uint32_t bufferSize, uint32_t sampleRate)
+{
+    return ULAW_SaveFileEx(stream, buffer, bufferSize, sampleRate, ULAW_WRITE_DEFAULT, NULL);
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_SaveFileEx
+
+    Description:
+        Writes mu-law encoded audio file, with write hints (see
+        ULAW_SaveChannels).
+
+    Parameters:
+        stream     - Output stream
+        buffer     - Samples to write
+        bufferSize - Number of samples
+        sampleRate - Samples per second
+        flags      - ULAW_WRITE_xxx hints (may be combined)
+        written    - Receives the number of samples actually written
+                     (may be NULL)
+
+    Return Value:
+        0 if successful, EIO on a short write (written then tells how
+        far the write went).
+ --------------------------------------------------------------------------*/
+
+int ULAW_SaveFileEx(FILE *stream, int16_t buffer[], uint32_t bufferSize, uint32_t sampleRate, int flags, uint32_t *written)
+{
+    return ULAW_SaveChannels(stream, &buffer, 1, bufferSize, sampleRate, flags, written);
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_SaveChannels
+
+    Description:
+        Writes mu-law encoded audio file of one or more channels (see
+        ULAW_SaveChannelsAs).
+ --------------------------------------------------------------------------*/
+
+int ULAW_SaveChannels(FILE *stream, int16_t *buffers[], uint16_t channels, uint32_t frames, uint32_t sampleRate, int flags, uint32_t *written)
+{
+    return ULAW_SaveChannelsAs(stream, buffers, channels, frames, sampleRate, ULAW_FORMAT_MULAW, ULAW_CONTAINER_AU, flags, written);
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_SaveChannelsAs
+
+    Description:
+        Writes an audio file of one or more channels, in a format and
+        a container. The samples are interleaved and encoded into a
+        block buffer which is flushed to the stream in large writes. A
+        single channel of 16-bit linear PCM in the byte order of the
+        host is written straight from the buffer, without conversion.
+
+    Parameters:
+        stream     - Output stream
+        buffers    - Samples of each channel
+        channels   - Number of channels
+        frames     - Number of samples per channel
+        sampleRate - Samples per second
+        format     - ULAW_FORMAT_xxx
+        container  - ULAW_CONTAINER_xxx
+        flags      - ULAW_WRITE_xxx hints (may be combined)
+        written    - Receives the number of frames (samples of every
+                     channel) actually written (may be NULL)
+
+    Return Value:
+        0 if successful, EINVAL if there is no channel or the format
+        is not supported, EOVERFLOW if the data is too large for the
+        header, ENOMEM, or EIO on a short write or a failed flush
+        (written then only counts the blocks known to be written).
+ --------------------------------------------------------------------------*/
+
+int ULAW_SaveChannelsAs(FILE *stream, int16_t *buffers[], uint16_t channels, uint32_t frames, uint32_t sampleRate,
+                        uint32_t format, int container, int flags, uint32_t *written)
 {
     audio_file_header_t header;
-    uint8_t             ulaw;
-    uint32_t            i;
-
-    header.magic        = AUDIO_FILE_MAGIC_NUMBER;
-    header.dataLocation = sizeof(audio_file_header_t);
-    header.dataSize     = bufferSize;
-    header.dataFormat   = 1;
-    header.sampleRate   = sampleRate;
-    header.channels     = 1;
-    header.info         = 0;
-    header.reserved     = 0;
+    uint8_t             wavHeader[WAV_FILE_HEADER_SIZE];
+    uint8_t             *block, *data;
+    uint32_t            sampleSize, frameBytes, headerSize, dataSize;
+    uint32_t            blockFrames, offset = 0, synced = 0, n, count;
+    uint16_t            c;
+    off_t               start;
+    int                 fd, direct, err = 0;
+    uint64_t            wall = 0, cpu = 0;
+
+    if (NULL != written) {
+        *written = 0;
+    }
+
+    if (NULL != threadStats) ReadClock(&wall, &cpu);
+
+    if ((0 == channels) ||
+        ((ULAW_FORMAT_MULAW != format) && (ULAW_FORMAT_PCM16 != format) && (ULAW_FORMAT_ALAW != format)) ||
+        ((ULAW_CONTAINER_AU != container) && (ULAW_CONTAINER_WAV != container))) {
+        return EINVAL;
+    }
+
+    sampleSize = ULAW_SAMPLE_SIZE(format);
+    frameBytes = channels * sampleSize;
+    headerSize = (ULAW_CONTAINER_WAV == container) ? WAV_FILE_HEADER_SIZE : sizeof(audio_file_header_t);
+
+    if (((uint64_t) frames * frameBytes) > (UINT32_MAX - WAV_FILE_HEADER_SIZE)) {
+        return EOVERFLOW;
+    }
+    dataSize = frames * frameBytes;
+
+    /*
+     * Write the file header.
+     */
+    if (ULAW_CONTAINER_WAV == container) {
+        MakeWavHeader(wavHeader, format, channels, sampleRate, dataSize);
+        if (1 != fwrite(wavHeader, sizeof(wavHeader), 1, stream)) {
+            return EIO;
+        }
+    } else {
+        header.magic        = AUDIO_FILE_MAGIC_NUMBER;
+        header.dataLocation = sizeof(audio_file_header_t);
+        header.dataSize     = dataSize;
+        header.dataFormat   = format;
+        header.sampleRate   = sampleRate;
+        header.channels     = channels;
+        header.info         = 0;
+        header.reserved     = 0;
 
 #ifdef LITTLE_ENDIAN
-    ByteSwapHeader(&header);
+        ByteSwapHeader(&header);
 #endif
 
+        if (1 != fwrite(&header, sizeof(audio_file_header_t), 1, stream)) {
+            return EIO;
+        }
+    }
+
+    blockFrames = ULAW_BLOCK_SIZE / frameBytes;
+    if (0 == blockFrames) {
+        blockFrames = 1;
+    }
+    block = (uint8_t *) malloc((size_t) blockFrames * frameBytes);
+    if (NULL == block) {
+        return ENOMEM;
+    }
+
+    pthread_once(&encodeTableOnce, InitEncodeTable);
+
+    direct = (1 == channels) && (ULAW_FORMAT_PCM16 == format) && (NATIVE_CONTAINER == container);
+
     /*
-     * Write the file header.
+     * The hints are advisory only, so failures (e.g. on a pipe) are
+     * ignored.
      */
-    if (1 != fwrite(&header, sizeof(audio_file_header_t), 1, stream)) {
-        return EIO;
+    fd = fileno(stream);
+    start = ftello(stream);
+    if (flags & ULAW_WRITE_SEQUENTIAL) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
     }
 
-    for (i = 0; i < bufferSize; i++) {
-        ulaw = Linear2ULAW(buffer[i]);
-        if (1 != fwrite(&ulaw, sizeof(uint8_t), 1, stream)) {
-            return EIO;
+    /*
+     * Encode one block of frames at a time and hand it to the stream.
+     * Blocks are flushed as they go, so that an error is reported
+     * against the block that caused it rather than at fclose().
+     */
+    while (offset < frames) {
+        n = ((frames - offset) < blockFrames) ? (frames - offset) : blockFrames;
+        if (direct) {
+            data = (uint8_t *) &buffers[0][offset];
+        } else if ((1 == channels) && (ULAW_FORMAT_MULAW == format)) {
+            ULAW_EncodeBlock(&buffers[0][offset], block, n);
+            data = block;
+        } else {
+            for (c = 0; c < channels; c++) {
+                EncodeSamples(&buffers[c][offset], n, format, container, &block[c * sampleSize], frameBytes);
+            }
+            data = block;
         }
+
+        count = (uint32_t) fwrite(data, sizeof(uint8_t), n * frameBytes, stream);
+        if (count != n * frameBytes) {
+            offset += count / frameBytes;
+            err = EIO;
+            break;
+        }
+
+        /*
+         * A block that can't be flushed may not have reached the file,
+         * so it isn't counted as written.
+         */
+        if (0 != fflush(stream)) {
+            err = EIO;
+            break;
+        }
+
+        offset += n;
+
+        /*
+         * Only clean pages can be dropped from the page cache, so the
+         * data is synced first, every ULAW_SYNC_SIZE bytes and at the
+         * end.
+         */
+        if ((flags & ULAW_WRITE_DONTNEED) && (start >= 0) &&
+            ((offset == frames) || (((uint64_t) (offset - synced) * frameBytes) >= ULAW_SYNC_SIZE))) {
+            if (0 == fdatasync(fd)) {
+                posix_fadvise(fd, start, (off_t) offset * frameBytes, POSIX_FADV_DONTNEED);
+            }
+            synced = offset;
+        }
+    }
+
+    if (NULL != written) {
+        *written = offset;
+    }
+
+    free(block);
+
+    if (NULL != threadStats) AddStats(threadStats, 1, headerSize + (uint64_t) offset * frameBytes, wall, cpu);
+
+    return err;
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_MapFile
+
+    Description:
+        Maps an audio file in memory (read-only), in any of the
+        formats of ULAW_ReadFile. Samples are decoded on demand by
+        ULAW_DecodeMap, so no copy of the whole file is needed.
+
+    Return Value:
+        0 on success; otherwise EINVAL if the file is not a supported
+        audio file, EIO if it can't be mapped or is truncated, or
+        ENOMEM.
+ --------------------------------------------------------------------------*/
+
+int ULAW_MapFile(FILE *stream, ulaw_map_t **map)
+{
+    ulaw_map_t  *p;
+    struct stat st;
+    void        *base;
+    int         fd = fileno(stream);
+    uint64_t    wall = 0, cpu = 0;
+
+    if (NULL != threadStats) ReadClock(&wall, &cpu);
+
+    if ((0 != fstat(fd, &st)) || (st.st_size < (off_t) sizeof(audio_file_header_t))) {
+        return EINVAL;
+    }
+
+    if (MAP_FAILED == (base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0))) {
+        return EIO;
+    }
+
+    if (NULL == (p = (ulaw_map_t *) calloc(1, sizeof(ulaw_map_t)))) {
+        munmap(base, (size_t) st.st_size);
+        return ENOMEM;
     }
 
+    p->base = (uint8_t *) base;
+    p->length = (size_t) st.st_size;
+
+    /*
+     * Parse the audio file header from the mapping and check if it's
+     * valid.
+     */
+    if ((0 != ParseHeader(p->base, p->length, &p->header, &p->container)) ||
+        (p->header.dataLocation > p->length)) {
+        ULAW_UnmapFile(p);
+        return EINVAL;
+    }
+
+    p->data = p->base + p->header.dataLocation;
+    p->frames = p->header.dataSize / (p->header.channels * ULAW_SAMPLE_SIZE(p->header.dataFormat));
+    if (((uint64_t) p->frames * p->header.channels * ULAW_SAMPLE_SIZE(p->header.dataFormat)) > (p->length - p->header.dataLocation)) {
+        ULAW_UnmapFile(p);
+        return EIO;
+    }
+
+    madvise(p->base, p->length, MADV_SEQUENTIAL);
+
+    /*
+     * The samples are only read when they are decoded, so only the
+     * header is read here.
+     */
+    if (NULL != (p->stats = threadStats)) AddStats(p->stats, 0, p->header.dataLocation, wall, cpu);
+
+    *map = p;
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_UnmapFile
+
+    Description:
+        Unmaps a file mapped by ULAW_MapFile.
+ --------------------------------------------------------------------------*/
+
+void ULAW_UnmapFile(ulaw_map_t *map)
+{
+    if (NULL == map) {
+        return;
+    }
+
+    munmap(map->base, map->length);
+    free(map);
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_GetMapInfo
+
+    Description:
+        Returns the number of samples per channel, the sample rate and
+        the number of channels of a mapped file. Any pointer may be
+        NULL.
+ --------------------------------------------------------------------------*/
+
+void ULAW_GetMapInfo(ulaw_map_t *map, uint32_t *frames, uint32_t *sampleRate, uint32_t *channels)
+{
+    if (NULL != frames) *frames = map->frames;
+    if (NULL != sampleRate) *sampleRate = map->header.sampleRate;
+    if (NULL != channels) *channels = map->header.channels;
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_GetMapFormat
+
+    Description:
+        Returns the format (ULAW_FORMAT_xxx) and the container
+        (ULAW_CONTAINER_xxx) of a mapped file, and the offset of its
+        samples in the file. Any pointer may be NULL.
+ --------------------------------------------------------------------------*/
+
+void ULAW_GetMapFormat(ulaw_map_t *map, uint32_t *format, int *container, uint32_t *dataLocation)
+{
+    if (NULL != format) *format = map->header.dataFormat;
+    if (NULL != container) *container = map->container;
+    if (NULL != dataLocation) *dataLocation = map->header.dataLocation;
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_GetMapSamples
+
+    Description:
+        Returns the samples of a mapped file when they can be used in
+        place, without any decoding: a single channel of 16-bit linear
+        PCM in the byte order of the host. The samples are counted as
+        read when they are returned, and stay valid until the file is
+        unmapped.
+
+    Return Value:
+        The samples (ULAW_GetMapInfo tells how many); otherwise NULL,
+        in which case ULAW_DecodeMap must be used.
+ --------------------------------------------------------------------------*/
+
+const int16_t *ULAW_GetMapSamples(ulaw_map_t *map)
+{
+    uint64_t wall = 0, cpu = 0;
+
+    if ((ULAW_FORMAT_PCM16 != map->header.dataFormat) || (NATIVE_CONTAINER != map->container) ||
+        (1 != map->header.channels) || (0 != ((uintptr_t) map->data & (sizeof(int16_t) - 1)))) {
+        return NULL;
+    }
+
+    if (NULL != map->stats) {
+        ReadClock(&wall, &cpu);
+        AddStats(map->stats, 0, (uint64_t) map->frames * sizeof(int16_t), wall, cpu);
+    }
+
+    return (const int16_t *) map->data;
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_DecodeMap
+
+    Description:
+        Decodes a window of samples of one channel (1 = first) of a
+        mapped file to linear.
+
+    Parameters:
+        map - Mapped file
+        channel - Channel to decode
+        offset - Index of the first sample of the window
+        count - Number of samples in the window
+        buffer - Decoded samples
+
+    Return Value:
+        0 on success; otherwise EINVAL.
+ --------------------------------------------------------------------------*/
+
+int ULAW_DecodeMap(ulaw_map_t *map, uint16_t channel, uint32_t offset, uint32_t count, int16_t buffer[])
+{
+    uint32_t channels = map->header.channels;
+    uint32_t sampleSize = ULAW_SAMPLE_SIZE(map->header.dataFormat);
+    uint8_t  *data;
+    uint64_t wall = 0, cpu = 0;
+
+    if ((0 == channel) || (channel > channels) || (offset > map->frames) || (count > (map->frames - offset))) {
+        return EINVAL;
+    }
+
+    if (NULL != map->stats) ReadClock(&wall, &cpu);
+
+    data = map->data + ((size_t) offset * channels + (channel - 1)) * sampleSize;
+    DecodeSamples(data, (size_t) channels * sampleSize, count, map->header.dataFormat, map->container, buffer);
+
+    if (NULL != map->stats) AddStats(map->stats, 0, (uint64_t) count * sampleSize, wall, cpu);
+
     return 0;
 }
+
+/*--------------------------------------------------------------------------
+    ULAW_DecodeBlock
+
+    Description:
+        Converts a block of ulaw samples to linear, by table lookup.
+        The result is the same as ULAW2Linear.
+ --------------------------------------------------------------------------*/
+
+void ULAW_DecodeBlock(uint8_t ulaw[], int16_t linear[], uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        linear[i] = decodeTable[ulaw[i]];
+    }
+}
+
+/*--------------------------------------------------------------------------
+    ULAW_EncodeBlock
+
+    Description:
+        Converts a block of linear samples to ulaw, by table lookup.
+        The result is the same as Linear2ULAW.
+ --------------------------------------------------------------------------*/
+
+void ULAW_EncodeBlock(int16_t linear[], uint8_t ulaw[], uint32_t count)
+{
+    uint32_t i;
+
+    pthread_once(&encodeTableOnce, InitEncodeTable);
+
+    for (i = 0; i < count; i++) {
+        ulaw[i] = encodeTable[ENCODE_INDEX(linear[i])];
+    }
+}
+
+/*--------------------------------------------------------------------------
+    ALAW_DecodeBlock
+
+    Description:
+        Converts a block of A-law samples to linear, by table lookup.
+        The result is the same as ALAW2Linear.
+ --------------------------------------------------------------------------*/
+
+void ALAW_DecodeBlock(uint8_t alaw[], int16_t linear[], uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        linear[i] = alawDecodeTable[alaw[i]];
+    }
+}
+
+/*--------------------------------------------------------------------------
+    ALAW_EncodeBlock
+
+    Description:
+        Converts a block of linear samples to A-law, by table lookup.
+        The result is the same as Linear2ALAW.
+ --------------------------------------------------------------------------*/
+
+void ALAW_EncodeBlock(int16_t linear[], uint8_t alaw[], uint32_t count)
+{
+    uint32_t i;
+
+    pthread_once(&encodeTableOnce, InitEncodeTable);
+
+    for (i = 0; i < count; i++) {
+        alaw[i] = alawEncodeTable[ALAW_INDEX(linear[i])];
+    }
+}
@@ -12,6 +12,7 @@
 #ifndef __ULAWAPI_H                             /* Prevent multiple includes */
 #define __ULAWAPI_H
 
+#include <stdio.h>
 #include "typedef.h"
 
 #ifdef __cplusplus
@@ -36,13 +37,61 @@ struct audio_file_header {
 typedef struct audio_file_header audio_file_header_t;
 
 #define AUDIO_FILE_MAGIC_NUMBER 0x2e736e64
+#define WAV_FILE_HEADER_SIZE    44U             /* Header written to RIFF/WAV files */
+
+#define ULAW_FORMAT_MULAW     1                 /* 8-bit G.711 mu-law */
+#define ULAW_FORMAT_PCM16     3                 /* 16-bit linear PCM */
+#define ULAW_FORMAT_ALAW      27                /* 8-bit G.711 A-law */
+
+#define ULAW_SAMPLE_SIZE(format) ((ULAW_FORMAT_PCM16 == (format)) ? 2U : 1U)
+
+#define ULAW_CONTAINER_AU     0                 /* Sun .au (big-endian) */
+#define ULAW_CONTAINER_WAV    1                 /* RIFF/WAV (little-endian) */
+
+#define ULAW_WRITE_DEFAULT    0x00              /* No hints */
+#define ULAW_WRITE_SEQUENTIAL 0x01              /* Output is written sequentially */
+#define ULAW_WRITE_DONTNEED   0x02              /* Drop written data from the page cache */
+
+typedef struct ulaw_map ulaw_map_t;             /* Opaque memory-mapped file */
+
+struct ulaw_stats {
+    uint64_t bytesRead;                         /* Bytes read or decoded from a map */
+    uint64_t readWallTime;                      /* Elapsed time reading (ns) */
+    uint64_t readCpuTime;                       /* CPU time reading (ns) */
+    uint64_t bytesWritten;                      /* Bytes written, headers included */
+    uint64_t writeWallTime;                     /* Elapsed time writing (ns) */
+    uint64_t writeCpuTime;                      /* CPU time writing (ns) */
+};
+
+typedef struct ulaw_stats ulaw_stats_t;
 
 /*--------------------------------------------------------------------------
     Prototypes
  --------------------------------------------------------------------------*/
 
+void ULAW_SetStats(ulaw_stats_t *stats);
+int16_t ULAW2Linear(uint8_t ulaw);
+uint8_t Linear2ULAW(int16_t sample);
+void ULAW_DecodeBlock(uint8_t ulaw[], int16_t linear[], uint32_t count);
+void ULAW_EncodeBlock(int16_t linear[], uint8_t ulaw[], uint32_t count);
+int16_t ALAW2Linear(uint8_t alaw);
+uint8_t Linear2ALAW(int16_t sample);
+void ALAW_DecodeBlock(uint8_t alaw[], int16_t linear[], uint32_t count);
+void ALAW_EncodeBlock(int16_t linear[], uint8_t alaw[], uint32_t count);
 int ULAW_ReadFile(uint16_t channel, FILE *stream, int16_t *buffer[], uint32_t *bufferSize, uint32_t *sampleRate);
+int ULAW_ReadFileInto(uint16_t channel, FILE *stream, int16_t buffer[], uint32_t capacity, uint32_t *bufferSize,
+                      uint32_t *sampleRate);
 int ULAW_SaveFile(FILE *stream, int16_t buffer[], uint32_t bufferSize, uint32_t sampleRate);
+int ULAW_SaveFileEx(FILE *stream, int16_t buffer[], uint32_t bufferSize, uint32_t sampleRate, int flags, uint32_t *written);
+int ULAW_SaveChannels(FILE *stream, int16_t *buffers[], uint16_t channels, uint32_t frames, uint32_t sampleRate, int flags, uint32_t *written);
+int ULAW_SaveChannelsAs(FILE *stream, int16_t *buffers[], uint16_t channels, uint32_t frames, uint32_t sampleRate,
+                        uint32_t format, int container, int flags, uint32_t *written);
+int ULAW_MapFile(FILE *stream, ulaw_map_t **map);
+void ULAW_UnmapFile(ulaw_map_t *map);
+void ULAW_GetMapInfo(ulaw_map_t *map, uint32_t *frames, uint32_t *sampleRate, uint32_t *channels);
+void ULAW_GetMapFormat(ulaw_map_t *map, uint32_t *format, int *container, uint32_t *dataLocation);
+const int16_t *ULAW_GetMapSamples(ulaw_map_t *map);
+int ULAW_DecodeMap(ulaw_map_t *map, uint16_t channel, uint32_t offset, uint32_t count, int16_t buffer[]);
 
 #ifdef __cplusplus
 }                                               /* End of extern "C" { */
@@ -0,0 +1,162 @@
+/*--------------------------------------------------------------------------
+    FILE                :   ulawbench.c
+
+    PURPOSE             :   Micro-benchmark of the ulaw codec (per-sample
+                            routines against the block routines), with a
+                            check of the A-law block routines
+
+    INITIAL CODING      :   Stephane Rheaume (SR)
+    (March 20th, 2016)
+
+        Copyright (c) Stephane Rheaume 2016, All rights reserved.
+ --------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "typedef.h"
+#include "ulawapi.h"
+
+/*--------------------------------------------------------------------------
+    Symbolic constants
+ --------------------------------------------------------------------------*/
+
+#define SAMPLES 16000000U                       /* Samples per run */
+#define RUNS    5                               /* Best of RUNS */
+
+/*--------------------------------------------------------------------------
+    Now
+
+    Description:
+        Returns a monotonic time stamp in seconds.
+ --------------------------------------------------------------------------*/
+
+double Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*--------------------------------------------------------------------------
+    Report
+
+    Description:
+        Prints one result line (name, ns/sample, Msamples/sec).
+ --------------------------------------------------------------------------*/
+
+void Report(const char *name, double seconds)
+{
+    printf("%-16s %8.3f ns/sample %10.1f Msamples/s\n", name, seconds * 1e9 / SAMPLES, SAMPLES / seconds / 1e6);
+}
+
+/*--------------------------------------------------------------------------
+    Main program
+ --------------------------------------------------------------------------*/
+
+int main(void)
+{
+    int16_t  *linear, *decoded;
+    uint8_t  *ulaw, *encoded;
+    double   t, best[4] = {1e9, 1e9, 1e9, 1e9};
+    uint32_t i, seed = 1;
+    int      run, sample;
+
+    linear  = (int16_t *) malloc(SAMPLES * sizeof(int16_t));
+    decoded = (int16_t *) malloc(SAMPLES * sizeof(int16_t));
+    ulaw    = (uint8_t *) malloc(SAMPLES);
+    encoded = (uint8_t *) malloc(SAMPLES);
+    if ((NULL == linear) || (NULL == decoded) || (NULL == ulaw) || (NULL == encoded)) {
+        fprintf(stderr, "Not enough memory\n");
+        return 1;
+    }
+
+    /*
+     * Check that the block routines match the per-sample routines on
+     * every possible input.
+     */
+    for (sample = -32768; sample <= 32767; sample++) {
+        int16_t s = (int16_t) sample;
+        uint8_t u;
+
+        ULAW_EncodeBlock(&s, &u, 1);
+        if (u != Linear2ULAW(s)) {
+            fprintf(stderr, "ULAW_EncodeBlock mismatch at %d\n", sample);
+            return 1;
+        }
+    }
+    for (sample = 0; sample < 256; sample++) {
+        uint8_t u = (uint8_t) sample;
+        int16_t s;
+
+        ULAW_DecodeBlock(&u, &s, 1);
+        if (s != ULAW2Linear(u)) {
+            fprintf(stderr, "ULAW_DecodeBlock mismatch at %d\n", sample);
+            return 1;
+        }
+    }
+
+    for (sample = -32768; sample <= 32767; sample++) {
+        int16_t s = (int16_t) sample;
+        uint8_t a;
+
+        ALAW_EncodeBlock(&s, &a, 1);
+        if (a != Linear2ALAW(s)) {
+            fprintf(stderr, "ALAW_EncodeBlock mismatch at %d\n", sample);
+            return 1;
+        }
+    }
+    for (sample = 0; sample < 256; sample++) {
+        uint8_t a = (uint8_t) sample;
+        int16_t s;
+
+        ALAW_DecodeBlock(&a, &s, 1);
+        if ((s != ALAW2Linear(a)) || (Linear2ALAW(s) != a)) {
+            fprintf(stderr, "ALAW_DecodeBlock mismatch at %d\n", sample);
+            return 1;
+        }
+    }
+
+    /*
+     * Deterministic test signal (LCG noise over the full 16-bit range).
+     */
+    for (i = 0; i < SAMPLES; i++) {
+        seed = seed * 1664525U + 1013904223U;
+        linear[i] = (int16_t) (seed >> 16);
+        ulaw[i] = (uint8_t) (seed >> 8);
+    }
+
+    for (run = 0; run < RUNS; run++) {
+        t = Now();
+        for (i = 0; i < SAMPLES; i++) decoded[i] = ULAW2Linear(ulaw[i]);
+        if ((t = Now() - t) < best[0]) best[0] = t;
+
+        t = Now();
+        ULAW_DecodeBlock(ulaw, decoded, SAMPLES);
+        if ((t = Now() - t) < best[1]) best[1] = t;
+
+        t = Now();
+        for (i = 0; i < SAMPLES; i++) encoded[i] = Linear2ULAW(linear[i]);
+        if ((t = Now() - t) < best[2]) best[2] = t;
+
+        t = Now();
+        ULAW_EncodeBlock(linear, encoded, SAMPLES);
+        if ((t = Now() - t) < best[3]) best[3] = t;
+    }
+
+    Report("ULAW2Linear", best[0]);
+    Report("ULAW_DecodeBlock", best[1]);
+    Report("Linear2ULAW", best[2]);
+    Report("ULAW_EncodeBlock", best[3]);
+
+    free(linear);
+    free(decoded);
+    free(ulaw);
+    free(encoded);
+
+    return 0;
+}